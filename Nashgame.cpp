@@ -3,11 +3,48 @@
 
 #include <iostream>
 #include <vector>
-#include <stack>
 #include <random>
 #include <ctime>
 #include <utility>
 #include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <new>
+#include <cstdlib>
+// AVX2 kernels: always built with -mavx2 (or /arch:AVX2); otherwise GCC and
+// Clang on x86 build them for AVX2 alone and pick them at run time
+#if defined(__AVX2__)
+#define NASH_AVX2 1
+#define NASH_AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NASH_AVX2 1
+#define NASH_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#ifdef NASH_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // Forward declarations
 class Board;
@@ -16,40 +53,1122 @@ class HumanPlayer;
 class RandomPlayer;
 class SmartPlayer;
 class MonteCarloPlayer;
+class FastRng;
+class TranspositionTable;
+class PlayoutEngine;
+class ThreadPool;
+class MctsPlayer;
+class AlphaBetaPlayer;
+class OpeningBook;
 
 // Define direction arrays globally instead of inside the Board class
 // This avoids issues with the default assignment operator
-const int DX[6] = {1, 1, 0, 0, -1, -1};
-const int DY[6] = {-1, 1, -1, 1, 0, 1};
+// The six hex neighbours are symmetric: every direction has its opposite
+constexpr int DX[6] = {1, 1, 0, 0, -1, -1};
+constexpr int DY[6] = {-1, 0, -1, 1, 0, 1};
+
+// The same directions in order around a cell, so consecutive entries are
+// neighbours of each other as well
+const int RING[6] = {0, 1, 3, 5, 4, 2};
+
+// Ring entries that fall off the board: beyond the left or right column the
+// edge belongs to White, beyond the top or bottom row to Black; a corner
+// belongs to neither
+const int RING_WHITE_EDGE = -1;
+const int RING_BLACK_EDGE = -2;
+const int RING_CORNER = -3;
+
+// Largest supported board; bitboards are sized for it so copies never allocate
+const int MAX_BOARD_SIZE = 64;
+const int MAX_CELLS = MAX_BOARD_SIZE * MAX_BOARD_SIZE;
+const int MAX_WORDS = (MAX_CELLS + 63) / 64;
+
+// Bitboard helpers
+// A bitboard is an array of 64-bit words where cell (x, y) of an n x n board
+// is bit x * n + y. Only the first numWords words of an array are meaningful.
+inline bool testBit(const uint64_t* bits, int index) {
+    return (bits[index >> 6] >> (index & 63)) & 1;
+}
+
+inline void setBit(uint64_t* bits, int index) {
+    bits[index >> 6] |= uint64_t(1) << (index & 63);
+}
+
+inline void clearBit(uint64_t* bits, int index) {
+    bits[index >> 6] &= ~(uint64_t(1) << (index & 63));
+}
+
+inline int countBits(const uint64_t* bits, int numWords) {
+    int count = 0;
+    for (int i = 0; i < numWords; i++) {
+        count += __builtin_popcountll(bits[i]);
+    }
+    return count;
+}
+
+inline bool intersects(const uint64_t* a, const uint64_t* b, int numWords) {
+    for (int i = 0; i < numWords; i++) {
+        if (a[i] & b[i]) return true;
+    }
+    return false;
+}
+
+// OR 'src' moved by 'offset' cell indices (negative moves towards index 0) into 'dst'
+inline void orShifted(uint64_t* dst, const uint64_t* src, int numWords, int offset) {
+    if (offset >= 0) {
+        int wordShift = offset >> 6;
+        int bitShift = offset & 63;
+        for (int i = numWords - 1; i >= wordShift; i--) {
+            uint64_t value = src[i - wordShift] << bitShift;
+            if (bitShift && i - wordShift - 1 >= 0) {
+                value |= src[i - wordShift - 1] >> (64 - bitShift);
+            }
+            dst[i] |= value;
+        }
+    } else {
+        int wordShift = (-offset) >> 6;
+        int bitShift = (-offset) & 63;
+        for (int i = 0; i + wordShift < numWords; i++) {
+            uint64_t value = src[i + wordShift] >> bitShift;
+            if (bitShift && i + wordShift + 1 < numWords) {
+                value |= src[i + wordShift + 1] << (64 - bitShift);
+            }
+            dst[i] |= value;
+        }
+    }
+}
+
+struct BoardKernels;
+const BoardKernels& kernelsForSize(int n);
+
+// Masks shared by all boards of one size, used for word-parallel neighbour
+// expansion. Built once for every supported size on first use.
+struct BoardGeometry {
+    int size;
+    int numCells;
+    int numWords;
+    int offset[6];                      // Index offset of each DX/DY direction
+    alignas(64) uint64_t canStep[6][MAX_WORDS];     // Cells whose neighbour in that direction is on the board
+    uint64_t leftEdge[MAX_WORDS];       // Column 0 (White starts here)
+    uint64_t rightEdge[MAX_WORDS];      // Column n-1 (White's goal)
+    uint64_t topEdge[MAX_WORDS];        // Row 0 (Black starts here)
+    uint64_t bottomEdge[MAX_WORDS];     // Row n-1 (Black's goal)
+    std::vector<int16_t> ring;          // Per cell, its six RING neighbours: a cell index or RING_* edge code
+    std::vector<int16_t> neighbours;    // Per cell, 6 slots: on-board neighbours in DX/DY order
+    std::vector<uint8_t> neighbourCount;    // Per cell, how many of those slots are used
+    const BoardKernels* kernels;        // Bitboard kernels for this size (see kernelsForSize)
+
+    static const BoardGeometry& forSize(int n) {
+        static const std::vector<BoardGeometry> geometries = buildAll();
+        return geometries[n];
+    }
+
+    // On-board neighbours of 'cell', in DX/DY order
+    const int16_t* neighboursOf(int cell) const {
+        return &neighbours[cell * 6];
+    }
+
+private:
+    static std::vector<BoardGeometry> buildAll() {
+        std::vector<BoardGeometry> all(MAX_BOARD_SIZE + 1);
+        for (int n = 1; n <= MAX_BOARD_SIZE; n++) {
+            BoardGeometry& g = all[n];
+            g.size = n;
+            g.numCells = n * n;
+            g.numWords = (n * n + 63) / 64;
+            g.kernels = &kernelsForSize(n);
+            std::fill(&g.canStep[0][0], &g.canStep[0][0] + 6 * MAX_WORDS, 0);
+            std::fill(g.leftEdge, g.leftEdge + MAX_WORDS, 0);
+            std::fill(g.rightEdge, g.rightEdge + MAX_WORDS, 0);
+            std::fill(g.topEdge, g.topEdge + MAX_WORDS, 0);
+            std::fill(g.bottomEdge, g.bottomEdge + MAX_WORDS, 0);
+            for (int d = 0; d < 6; d++) {
+                g.offset[d] = DX[d] * n + DY[d];
+            }
+            for (int x = 0; x < n; x++) {
+                for (int y = 0; y < n; y++) {
+                    int index = x * n + y;
+                    for (int d = 0; d < 6; d++) {
+                        int nx = x + DX[d];
+                        int ny = y + DY[d];
+                        if (nx >= 0 && nx < n && ny >= 0 && ny < n) {
+                            setBit(g.canStep[d], index);
+                        }
+                    }
+                    int count = 0;
+                    for (int d = 0; d < 6; d++) {
+                        int nx = x + DX[d];
+                        int ny = y + DY[d];
+                        if (nx >= 0 && nx < n && ny >= 0 && ny < n) {
+                            g.neighbours.push_back(static_cast<int16_t>(nx * n + ny));
+                            count++;
+                        }
+                    }
+                    g.neighbours.resize(g.neighbours.size() + 6 - count, -1);
+                    g.neighbourCount.push_back(static_cast<uint8_t>(count));
+                    for (int r = 0; r < 6; r++) {
+                        int nx = x + DX[RING[r]];
+                        int ny = y + DY[RING[r]];
+                        bool xInside = nx >= 0 && nx < n;
+                        bool yInside = ny >= 0 && ny < n;
+                        int entry = nx * n + ny;
+                        if (!xInside && !yInside) entry = RING_CORNER;
+                        else if (!yInside) entry = RING_WHITE_EDGE;
+                        else if (!xInside) entry = RING_BLACK_EDGE;
+                        g.ring.push_back(static_cast<int16_t>(entry));
+                    }
+                    if (y == 0) setBit(g.leftEdge, index);
+                    if (y == n - 1) setBit(g.rightEdge, index);
+                    if (x == 0) setBit(g.topEdge, index);
+                    if (x == n - 1) setBit(g.bottomEdge, index);
+                }
+            }
+        }
+        return all;
+    }
+};
+
+// Size-specialised bitboard kernels
+// The word-parallel loops of Board (flood fill, connection distance, full
+// board and straight-line checks) are written once against a "shape" that
+// supplies the word count, direction offsets and masks of a board size.
+// FixedShape<N> makes all of these compile-time constants, so each loop has
+// a fixed trip count the compiler can unroll and the masks become immediates;
+// DynamicShape reads them from BoardGeometry at run time. Every size gets a
+// table of kernel functions, instantiated with FixedShape for the common
+// sizes and with DynamicShape for the rest, and Board calls through it.
+
+// Compile-time masks of an N x N board, the same ones BoardGeometry builds
+template <int N>
+struct FixedShape {
+    static constexpr int CELLS = N * N;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+    static constexpr int STORED = (WORDS + 3) / 4 * 4;     // Whole 256-bit vectors, zero past WORDS
+    
+    struct Masks {
+        alignas(32) uint64_t canStep[6][STORED] = {};
+        alignas(32) uint64_t leftEdge[STORED] = {};
+        alignas(32) uint64_t rightEdge[STORED] = {};
+        alignas(32) uint64_t topEdge[STORED] = {};
+        alignas(32) uint64_t bottomEdge[STORED] = {};
+        
+        constexpr Masks() {
+            for (int x = 0; x < N; x++) {
+                for (int y = 0; y < N; y++) {
+                    int index = x * N + y;
+                    uint64_t bit = uint64_t(1) << (index & 63);
+                    for (int d = 0; d < 6; d++) {
+                        int nx = x + DX[d];
+                        int ny = y + DY[d];
+                        if (nx >= 0 && nx < N && ny >= 0 && ny < N) canStep[d][index >> 6] |= bit;
+                    }
+                    if (y == 0) leftEdge[index >> 6] |= bit;
+                    if (y == N - 1) rightEdge[index >> 6] |= bit;
+                    if (x == 0) topEdge[index >> 6] |= bit;
+                    if (x == N - 1) bottomEdge[index >> 6] |= bit;
+                }
+            }
+        }
+    };
+    static constexpr Masks masks = Masks();
+    
+    explicit FixedShape(const BoardGeometry&) {}
+    static constexpr int size() { return N; }
+    static constexpr int numCells() { return CELLS; }
+    static constexpr int numWords() { return WORDS; }
+    static constexpr int offset(int d) { return DX[d] * N + DY[d]; }
+    static constexpr const uint64_t* canStep(int d) { return masks.canStep[d]; }
+    static constexpr const uint64_t* leftEdge() { return masks.leftEdge; }
+    static constexpr const uint64_t* rightEdge() { return masks.rightEdge; }
+    static constexpr const uint64_t* topEdge() { return masks.topEdge; }
+    static constexpr const uint64_t* bottomEdge() { return masks.bottomEdge; }
+};
+
+// The same interface over the run-time masks of any size
+struct DynamicShape {
+    const BoardGeometry& geometry;
+    
+    explicit DynamicShape(const BoardGeometry& g) : geometry(g) {}
+    int size() const { return geometry.size; }
+    int numCells() const { return geometry.numCells; }
+    int numWords() const { return geometry.numWords; }
+    int offset(int d) const { return geometry.offset[d]; }
+    const uint64_t* canStep(int d) const { return geometry.canStep[d]; }
+    const uint64_t* leftEdge() const { return geometry.leftEdge; }
+    const uint64_t* rightEdge() const { return geometry.rightEdge; }
+    const uint64_t* topEdge() const { return geometry.topEdge; }
+    const uint64_t* bottomEdge() const { return geometry.bottomEdge; }
+};
+
+// dst = src plus every cell adjacent to a cell in src
+template <class Shape>
+inline void expandBits(const Shape& shape, const uint64_t* src, uint64_t* dst) {
+    const int numWords = shape.numWords();
+    uint64_t stepping[MAX_WORDS];
+    for (int i = 0; i < numWords; i++) {
+        dst[i] = src[i];
+    }
+#pragma GCC unroll 6
+    for (int d = 0; d < 6; d++) {
+        for (int i = 0; i < numWords; i++) {
+            stepping[i] = src[i] & shape.canStep(d)[i];
+        }
+        orShifted(dst, stepping, numWords, shape.offset(d));
+    }
+}
+
+// True if 'stones' contain a connected chain touching both 'from' and 'to'
+template <class Shape>
+bool connectsBits(const Shape& shape, const uint64_t* stones, const uint64_t* from, const uint64_t* to) {
+    const int numWords = shape.numWords();
+    uint64_t reached[MAX_WORDS];
+    uint64_t expanded[MAX_WORDS];
+    for (int i = 0; i < numWords; i++) {
+        reached[i] = stones[i] & from[i];
+    }
+    while (!intersects(reached, to, numWords)) {
+        expandBits(shape, reached, expanded);
+        bool grew = false;
+        for (int i = 0; i < numWords; i++) {
+            uint64_t next = expanded[i] & stones[i];
+            grew |= next != reached[i];
+            reached[i] = next;
+        }
+        if (!grew) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Connection distance of 'playerType' (see Board::connectionDistance)
+template <class Shape>
+int connectionDistanceBits(const Shape& shape, const uint64_t* white, const uint64_t* black, int playerType) {
+    const int numWords = shape.numWords();
+    const uint64_t* own = playerType == 1 ? white : black;
+    const uint64_t* from = playerType == 1 ? shape.leftEdge() : shape.topEdge();
+    const uint64_t* to = playerType == 1 ? shape.rightEdge() : shape.bottomEdge();
+    uint64_t empty[MAX_WORDS];
+    uint64_t reached[MAX_WORDS];
+    uint64_t expanded[MAX_WORDS];
+    for (int i = 0; i < numWords; i++) {
+        empty[i] = ~(white[i] | black[i]);
+        reached[i] = own[i] & from[i];
+    }
+    
+    for (int distance = 0; ; distance++) {
+        // Everything reachable through own stones costs the same
+        bool grew = true;
+        while (grew) {
+            expandBits(shape, reached, expanded);
+            grew = false;
+            for (int i = 0; i < numWords; i++) {
+                uint64_t next = reached[i] | (expanded[i] & own[i]);
+                grew |= next != reached[i];
+                reached[i] = next;
+            }
+        }
+        if (intersects(reached, to, numWords)) {
+            return distance;
+        }
+        
+        // Next layer: one more empty cell, next to the reached set or on the start edge
+        expandBits(shape, reached, expanded);
+        grew = false;
+        for (int i = 0; i < numWords; i++) {
+            uint64_t next = reached[i] | ((expanded[i] | from[i]) & empty[i]);
+            grew |= next != reached[i];
+            reached[i] = next;
+        }
+        if (!grew) {
+            return shape.numCells() + 1;
+        }
+    }
+}
+
+// True if 'stones' fill a whole row (White, 1) or column (Black, -1). Runs
+// are grown from the start edge one step right (or down) at a time, for all
+// rows (or columns) at once.
+template <class Shape>
+bool hasLineBits(const Shape& shape, const uint64_t* stones, int playerType) {
+    const int numWords = shape.numWords();
+    const int direction = playerType == 1 ? 3 : 1;      // DX/DY index of (0, 1) or (1, 0)
+    const uint64_t* start = playerType == 1 ? shape.leftEdge() : shape.topEdge();
+    uint64_t runs[MAX_WORDS];
+    uint64_t stepping[MAX_WORDS];
+    bool any = false;
+    for (int i = 0; i < numWords; i++) {
+        runs[i] = stones[i] & start[i];
+        any |= runs[i] != 0;
+    }
+    for (int step = 1; step < shape.size() && any; step++) {
+        for (int i = 0; i < numWords; i++) {
+            stepping[i] = runs[i] & shape.canStep(direction)[i];
+            runs[i] = 0;
+        }
+        orShifted(runs, stepping, numWords, shape.offset(direction));
+        any = false;
+        for (int i = 0; i < numWords; i++) {
+            runs[i] &= stones[i];
+            any |= runs[i] != 0;
+        }
+    }
+    return any;
+}
+
+#ifdef NASH_AVX2
+// AVX2 versions of the flood-fill kernels for FixedShape, four words per
+// instruction. The set being grown lives in a zero-padded buffer, and a
+// neighbour expansion loads it shifted by each direction's offset and masks
+// the cells that can be reached from that side: the cells that can step
+// back in the opposite direction (DX/DY index 5 - d). Board arrays are read
+// with masked loads past the last word, so nothing beyond it is touched.
+// Every member is compiled for AVX2 even when the rest of the program is not;
+// kernelsForSize only uses them on a processor that has it.
+template <int N>
+struct AvxKernels {
+    using Shape = FixedShape<N>;
+    static constexpr int WORDS = Shape::WORDS;
+    static constexpr int CHUNKS = (WORDS + 3) / 4;
+    static constexpr int PAD = 4;       // Zero words before and after the set
+    
+    // Words 4c .. 4c + 3 of a board array; words past the last one read as zero
+    NASH_AVX2_TARGET static __m256i load(const uint64_t* bits, int c) {
+        if (4 * c + 4 <= WORDS) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + 4 * c));
+        }
+        const __m256i tail = _mm256_setr_epi64x(4 * c < WORDS ? -1 : 0, 4 * c + 1 < WORDS ? -1 : 0,
+                                                4 * c + 2 < WORDS ? -1 : 0, 4 * c + 3 < WORDS ? -1 : 0);
+        return _mm256_maskload_epi64(reinterpret_cast<const long long*>(bits + 4 * c), tail);
+    }
+    
+    NASH_AVX2_TARGET static __m256i mask(const uint64_t* bits, int c) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(bits + 4 * c));
+    }
+    
+    // Chunk c of the padded set 'padded' moved by 'offset' cells
+    NASH_AVX2_TARGET static __m256i shifted(const uint64_t* padded, int c, int offset) {
+        const uint64_t* base = padded + PAD + 4 * c;
+        int distance = offset >= 0 ? offset : -offset;
+        int words = distance >> 6;
+        __m128i bits = _mm_cvtsi32_si128(distance & 63);
+        __m128i carry = _mm_cvtsi32_si128(64 - (distance & 63));
+        if (offset >= 0) {
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base - words));
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base - words - 1));
+            return _mm256_or_si256(_mm256_sll_epi64(high, bits), _mm256_srl_epi64(low, carry));
+        }
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + words));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + words + 1));
+        return _mm256_or_si256(_mm256_srl_epi64(low, bits), _mm256_sll_epi64(high, carry));
+    }
+    
+    // Chunk c of the padded set plus all its neighbours
+    NASH_AVX2_TARGET static __m256i expand(const uint64_t* padded, int c) {
+        __m256i result = _mm256_load_si256(reinterpret_cast<const __m256i*>(padded + PAD + 4 * c));
+        for (int d = 0; d < 6; d++) {
+            __m256i moved = shifted(padded, c, Shape::offset(d));
+            result = _mm256_or_si256(result, _mm256_and_si256(moved, mask(Shape::canStep(5 - d), c)));
+        }
+        return result;
+    }
+    
+    NASH_AVX2_TARGET static void store(uint64_t* padded, int c, __m256i value) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(padded + PAD + 4 * c), value);
+    }
+    
+    NASH_AVX2_TARGET static bool connects(const uint64_t* stones, const uint64_t* from, const uint64_t* to) {
+        alignas(32) uint64_t reached[PAD + 4 * CHUNKS + PAD] = {};
+        __m256i own[CHUNKS];
+        __m256i goal[CHUNKS];
+        for (int c = 0; c < CHUNKS; c++) {
+            own[c] = load(stones, c);
+            goal[c] = load(to, c);
+            store(reached, c, _mm256_and_si256(own[c], load(from, c)));
+        }
+        while (true) {
+            __m256i next[CHUNKS];
+            __m256i touched = _mm256_setzero_si256();
+            __m256i changed = _mm256_setzero_si256();
+            for (int c = 0; c < CHUNKS; c++) {
+                __m256i current = mask(reached + PAD, c);
+                touched = _mm256_or_si256(touched, _mm256_and_si256(current, goal[c]));
+                next[c] = _mm256_and_si256(expand(reached, c), own[c]);
+                changed = _mm256_or_si256(changed, _mm256_xor_si256(next[c], current));
+            }
+            if (!_mm256_testz_si256(touched, touched)) return true;
+            if (_mm256_testz_si256(changed, changed)) return false;
+            for (int c = 0; c < CHUNKS; c++) {
+                store(reached, c, next[c]);
+            }
+        }
+    }
+    
+    NASH_AVX2_TARGET static int connectionDistance(const uint64_t* white, const uint64_t* black, int playerType) {
+        const uint64_t* own = playerType == 1 ? white : black;
+        const uint64_t* from = playerType == 1 ? Shape::leftEdge() : Shape::topEdge();
+        const uint64_t* to = playerType == 1 ? Shape::rightEdge() : Shape::bottomEdge();
+        alignas(32) uint64_t reached[PAD + 4 * CHUNKS + PAD] = {};
+        __m256i stones[CHUNKS];
+        __m256i empty[CHUNKS];
+        __m256i start[CHUNKS];
+        __m256i goal[CHUNKS];
+        for (int c = 0; c < CHUNKS; c++) {
+            stones[c] = load(own, c);
+            start[c] = mask(from, c);
+            goal[c] = mask(to, c);
+            empty[c] = _mm256_andnot_si256(_mm256_or_si256(load(white, c), load(black, c)), _mm256_set1_epi64x(-1));
+            store(reached, c, _mm256_and_si256(stones[c], start[c]));
+        }
+        
+        for (int distance = 0; ; distance++) {
+            // Everything reachable through own stones costs the same
+            bool grew = true;
+            while (grew) {
+                __m256i next[CHUNKS];
+                __m256i changed = _mm256_setzero_si256();
+                for (int c = 0; c < CHUNKS; c++) {
+                    __m256i current = mask(reached + PAD, c);
+                    next[c] = _mm256_or_si256(current, _mm256_and_si256(expand(reached, c), stones[c]));
+                    changed = _mm256_or_si256(changed, _mm256_xor_si256(next[c], current));
+                }
+                grew = !_mm256_testz_si256(changed, changed);
+                for (int c = 0; c < CHUNKS; c++) {
+                    store(reached, c, next[c]);
+                }
+            }
+            __m256i touched = _mm256_setzero_si256();
+            for (int c = 0; c < CHUNKS; c++) {
+                touched = _mm256_or_si256(touched, _mm256_and_si256(mask(reached + PAD, c), goal[c]));
+            }
+            if (!_mm256_testz_si256(touched, touched)) {
+                return distance;
+            }
+            
+            // Next layer: one more empty cell, next to the reached set or on the start edge
+            __m256i next[CHUNKS];
+            __m256i changed = _mm256_setzero_si256();
+            for (int c = 0; c < CHUNKS; c++) {
+                __m256i current = mask(reached + PAD, c);
+                __m256i reachable = _mm256_and_si256(_mm256_or_si256(expand(reached, c), start[c]), empty[c]);
+                next[c] = _mm256_or_si256(current, reachable);
+                changed = _mm256_or_si256(changed, _mm256_xor_si256(next[c], current));
+            }
+            if (_mm256_testz_si256(changed, changed)) {
+                return Shape::CELLS + 1;
+            }
+            for (int c = 0; c < CHUNKS; c++) {
+                store(reached, c, next[c]);
+            }
+        }
+    }
+};
+
+// True if the processor running the program has AVX2
+inline bool cpuHasAvx2() {
+#if defined(__AVX2__)
+    return true;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// The kernels of one board size, reached through BoardGeometry::kernels
+struct BoardKernels {
+    bool (*connects)(const BoardGeometry&, const uint64_t* stones, const uint64_t* from, const uint64_t* to);
+    int (*connectionDistance)(const BoardGeometry&, const uint64_t* white, const uint64_t* black, int playerType);
+    bool (*hasLine)(const BoardGeometry&, const uint64_t* stones, int playerType);
+    
+    template <class Shape>
+    static BoardKernels make() {
+        return {
+            [](const BoardGeometry& g, const uint64_t* stones, const uint64_t* from, const uint64_t* to) {
+                return connectsBits(Shape(g), stones, from, to);
+            },
+            [](const BoardGeometry& g, const uint64_t* white, const uint64_t* black, int playerType) {
+                return connectionDistanceBits(Shape(g), white, black, playerType);
+            },
+            [](const BoardGeometry& g, const uint64_t* stones, int playerType) {
+                return hasLineBits(Shape(g), stones, playerType);
+            },
+        };
+    }
+    
+#ifdef NASH_AVX2
+    // FixedShape<N> with the AVX2 flood fill and connectionDistance
+    template <int N>
+    static BoardKernels makeAvx() {
+        BoardKernels kernels = make<FixedShape<N>>();
+        kernels.connects = [](const BoardGeometry&, const uint64_t* stones, const uint64_t* from, const uint64_t* to) {
+            return AvxKernels<N>::connects(stones, from, to);
+        };
+        kernels.connectionDistance = [](const BoardGeometry&, const uint64_t* white, const uint64_t* black,
+                                        int playerType) {
+            return AvxKernels<N>::connectionDistance(white, black, playerType);
+        };
+        return kernels;
+    }
+#endif
+};
+
+// Boards of three or more words (13x13 and up) use the AVX2 kernels when the
+// processor has AVX2; one or two words are faster in general-purpose registers
+template <int N>
+BoardKernels fixedKernels() {
+#ifdef NASH_AVX2
+    if constexpr (FixedShape<N>::WORDS >= 3) {
+        if (cpuHasAvx2()) return BoardKernels::makeAvx<N>();
+    }
+#endif
+    return BoardKernels::make<FixedShape<N>>();
+}
+
+// Sizes with compiled-in kernels; any other size uses DynamicShape
+const BoardKernels& kernelsForSize(int n) {
+    static const BoardKernels dynamic = BoardKernels::make<DynamicShape>();
+    static const BoardKernels size7 = fixedKernels<7>();
+    static const BoardKernels size9 = fixedKernels<9>();
+    static const BoardKernels size11 = fixedKernels<11>();
+    static const BoardKernels size13 = fixedKernels<13>();
+    static const BoardKernels size19 = fixedKernels<19>();
+    switch (n) {
+        case 7: return size7;
+        case 9: return size9;
+        case 11: return size11;
+        case 13: return size13;
+        case 19: return size19;
+        default: return dynamic;
+    }
+}
+
+// Derive an independent RNG seed from a base seed and a task number
+// (SplitMix64 finaliser), so a task's random stream does not depend on
+// which thread happens to run it
+inline unsigned int mixSeed(uint64_t base, uint64_t task) {
+    uint64_t z = base + 0x9E3779B97F4A7C15ULL * (task + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<unsigned int>(z ^ (z >> 31));
+}
+
+// Small, fast generator (xoshiro256**) used for all game randomness.
+// Every player and playout engine owns one, seeded explicitly, so no state
+// is shared between threads and a game can be replayed from its seed. It
+// meets the standard UniformRandomBitGenerator requirements, so it also
+// works with std::shuffle and the <random> distributions.
+class FastRng {
+private:
+    uint64_t state[4];
+    
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+    
+public:
+    using result_type = uint64_t;
+    
+    explicit FastRng(uint64_t value = 0) {
+        seed(value);
+    }
+    
+    // Expand the seed with SplitMix64, which never yields an all-zero state
+    void seed(uint64_t value) {
+        for (int i = 0; i < 4; i++) {
+            value += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+    
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    
+    result_type operator()() {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+};
+
+// Generator type used by players and playouts; any 64-bit
+// UniformRandomBitGenerator (e.g. std::mt19937_64) can be dropped in here
+using Rng = FastRng;
+
+// Uniform integer in [0, bound) without modulo bias (Lemire's
+// multiply-and-shift; a draw is rejected only in the rare case that it falls
+// into the uneven remainder). bound must be at least 1.
+template <class Generator>
+inline uint32_t randomBelow(Generator& rng, uint32_t bound) {
+    uint64_t product = static_cast<uint64_t>(static_cast<uint32_t>(rng() >> 32)) * bound;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < bound) {
+        const uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = static_cast<uint64_t>(static_cast<uint32_t>(rng() >> 32)) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+// Zobrist hashing
+// Every (cell, colour) pair gets a fixed random 64-bit key and a position's
+// hash is the XOR of the keys of its stones, so placing or removing a stone
+// updates the hash with a single XOR. The keys come from a fixed seed and are
+// the same in every run.
+struct ZobristKeys {
+    uint64_t white[MAX_CELLS];
+    uint64_t black[MAX_CELLS];
+    
+    static const ZobristKeys& instance() {
+        static const ZobristKeys keys;
+        return keys;
+    }
+    
+    uint64_t key(int cell, int playerType) const {
+        return playerType == 1 ? white[cell] : black[cell];
+    }
+    
+private:
+    ZobristKeys() {
+        FastRng rng(0x5A0B1D7ULL);
+        for (int i = 0; i < MAX_CELLS; i++) {
+            white[i] = rng();
+            black[i] = rng();
+        }
+    }
+};
+
+// Up to six neighbouring cells as (x, y) pairs, stored inline so building
+// and returning one never allocates
+struct NeighbourList {
+    std::pair<int, int> cells[6];
+    int count = 0;
+    
+    void push(int x, int y) {
+        cells[count++] = {x, y};
+    }
+    
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const std::pair<int, int>& operator[](int i) const { return cells[i]; }
+    const std::pair<int, int>* begin() const { return cells; }
+    const std::pair<int, int>* end() const { return cells + count; }
+};
+
+// Instrumentation
+// Hot paths count calls with NASH_COUNT and time phases with NASH_PHASE,
+// into counters owned by the running thread. A count is a plain add to
+// memory no other thread writes. A phase reads the clock only while timing
+// is switched on at run time. While tracing is on, it is also kept as a
+// Chrome trace event. Building with -DNASH_NO_TELEMETRY compiles the macros
+// and the allocation counter out; the per-move log then only has what the
+// players report themselves.
+
+enum TelemetryCounter {
+    COUNT_BOARD_COPIES,
+    COUNT_MOVES,
+    COUNT_UNDOS,
+    COUNT_WIN_CHECKS,           // hasWon
+    COUNT_FLOOD_FILLS,          // connects (flood-fill win checks and playout scoring)
+    COUNT_DFS_SEARCHES,         // hasWonByDfs
+    COUNT_DISTANCES,            // connectionDistance
+    COUNT_EVALUATIONS,          // evaluatePosition
+    COUNT_PLAYOUTS,
+    COUNT_ALLOCATIONS,
+    COUNT_ALLOCATED_BYTES,
+    NUM_COUNTERS
+};
+
+const char* const COUNTER_NAMES[NUM_COUNTERS] = {
+    "board_copies", "moves", "undos", "win_checks", "flood_fills", "dfs_searches",
+    "distances", "evaluations", "playouts", "allocations", "allocated_bytes"
+};
+
+enum TelemetryPhase {
+    PHASE_SEARCH,               // A player choosing its move
+    PHASE_PLAYOUTS,             // Random playouts
+    PHASE_EXPANSION,            // Generating and ordering moves of a tree node
+    PHASE_EVALUATION,           // Static evaluation of a position
+    NUM_PHASES
+};
+
+const char* const PHASE_NAMES[NUM_PHASES] = {"search", "playouts", "expansion", "evaluation"};
+
+// Counter and phase totals at one moment; subtract two to get the work in between
+struct TelemetrySnapshot {
+    uint64_t counts[NUM_COUNTERS] = {};
+    uint64_t phaseNanos[NUM_PHASES] = {};
+    
+    TelemetrySnapshot operator-(const TelemetrySnapshot& other) const {
+        TelemetrySnapshot result;
+        for (int i = 0; i < NUM_COUNTERS; i++) result.counts[i] = counts[i] - other.counts[i];
+        for (int i = 0; i < NUM_PHASES; i++) result.phaseNanos[i] = phaseNanos[i] - other.phaseNanos[i];
+        return result;
+    }
+};
+
+class Telemetry {
+public:
+    // One timed phase, for the trace file
+    struct TraceEvent {
+        int phase;
+        int64_t startNanos;     // Since the telemetry epoch
+        int64_t nanos;
+    };
+    
+    // Counters and trace events of one thread. Only the owner writes them;
+    // the relaxed atomics let snapshots read them from other threads.
+    struct ThreadBlock {
+        std::atomic<uint64_t> counts[NUM_COUNTERS];
+        std::atomic<uint64_t> phaseNanos[NUM_PHASES];
+        std::vector<TraceEvent> events;
+        int threadId;
+        
+        ThreadBlock() {
+            for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+            for (auto& nanos : phaseNanos) nanos.store(0, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            threadId = registry().nextThreadId++;
+            registry().blocks.push_back(this);
+            current() = this;
+        }
+        
+        // Keep a finished thread's totals and events
+        ~ThreadBlock() {
+            current() = nullptr;
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (int i = 0; i < NUM_COUNTERS; i++) r.retired.counts[i] += counts[i].load(std::memory_order_relaxed);
+            for (int i = 0; i < NUM_PHASES; i++) r.retired.phaseNanos[i] += phaseNanos[i].load(std::memory_order_relaxed);
+            for (const TraceEvent& event : events) r.retiredEvents.push_back({threadId, event});
+            r.blocks.erase(std::find(r.blocks.begin(), r.blocks.end(), this));
+        }
+        
+        void add(int counter, uint64_t amount) {
+            counts[counter].store(counts[counter].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+        
+        void addPhase(int phase, int64_t startNanos, int64_t nanos) {
+            phaseNanos[phase].store(phaseNanos[phase].load(std::memory_order_relaxed) + nanos,
+                                    std::memory_order_relaxed);
+            if (tracing().load(std::memory_order_relaxed)) {
+                if (events.size() < MAX_TRACE_EVENTS) {
+                    events.push_back({phase, startNanos, nanos});
+                } else {
+                    registry().droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+    
+    static const size_t MAX_TRACE_EVENTS = 1 << 20;     // Per thread; later events are dropped
+    
+    // The calling thread's block, created on first use
+    static ThreadBlock& local() {
+        thread_local ThreadBlock block;
+        return block;
+    }
+    
+    // The calling thread's block if it exists yet, for the allocation
+    // counter, which must not create one (that allocates)
+    static ThreadBlock*& current() {
+        thread_local ThreadBlock* block = nullptr;
+        return block;
+    }
+    
+    // Phases are timed only while this is set
+    static std::atomic<bool>& timing() {
+        static std::atomic<bool> enabled(false);
+        return enabled;
+    }
+    
+    // Timed phases are also kept as trace events while this is set
+    static std::atomic<bool>& tracing() {
+        static std::atomic<bool> enabled(false);
+        return enabled;
+    }
+    
+    static int64_t nowNanos() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+    
+    // Totals of the calling thread, or of every thread that ever counted anything
+    static TelemetrySnapshot snapshot(bool allThreads) {
+        TelemetrySnapshot result;
+        auto addBlock = [&](const ThreadBlock& block) {
+            for (int i = 0; i < NUM_COUNTERS; i++) result.counts[i] += block.counts[i].load(std::memory_order_relaxed);
+            for (int i = 0; i < NUM_PHASES; i++) {
+                result.phaseNanos[i] += block.phaseNanos[i].load(std::memory_order_relaxed);
+            }
+        };
+        if (!allThreads) {
+            addBlock(local());
+            return result;
+        }
+        local();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        result = r.retired;
+        for (const ThreadBlock* block : r.blocks) addBlock(*block);
+        return result;
+    }
+    
+    // Write every trace event so far as a Chrome trace-event file (load it in
+    // chrome://tracing or Perfetto). Call when no other thread is working.
+    static bool writeTrace(const std::string& path) {
+        std::ofstream out(path);
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        auto write = [&](int threadId, const TraceEvent& event) {
+            out << (first ? "\n" : ",\n") << "{\"name\":\"" << PHASE_NAMES[event.phase]
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+                << ",\"ts\":" << event.startNanos / 1000.0 << ",\"dur\":" << event.nanos / 1000.0 << "}";
+            first = false;
+        };
+        out << std::fixed << std::setprecision(3);
+        for (const auto& item : r.retiredEvents) write(item.first, item.second);
+        for (const ThreadBlock* block : r.blocks) {
+            for (const TraceEvent& event : block->events) write(block->threadId, event);
+        }
+        out << "\n],\"otherData\":{\"dropped_events\":\"" << r.droppedEvents.load() << "\"}}" << std::endl;
+        return static_cast<bool>(out);
+    }
+    
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::vector<ThreadBlock*> blocks;
+        TelemetrySnapshot retired;                  // Totals of finished threads
+        std::vector<std::pair<int, TraceEvent>> retiredEvents;
+        std::atomic<uint64_t> droppedEvents{0};
+        int nextThreadId = 0;
+    };
+    
+    static Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+};
+
+// Times the enclosing scope as one phase while timing is on
+class PhaseTimer {
+private:
+    int phase;
+    int64_t start;      // -1 when timing is off
+    
+public:
+    explicit PhaseTimer(int timedPhase)
+        : phase(timedPhase), start(Telemetry::timing().load(std::memory_order_relaxed) ? Telemetry::nowNanos() : -1) {}
+    
+    ~PhaseTimer() {
+        if (start >= 0) {
+            Telemetry::local().addPhase(phase, start, Telemetry::nowNanos() - start);
+        }
+    }
+};
+
+#ifndef NASH_NO_TELEMETRY
+#define NASH_COUNT(counter) Telemetry::local().add(counter, 1)
+#define NASH_PHASE_NAME2(line) nashPhase##line
+#define NASH_PHASE_NAME(line) NASH_PHASE_NAME2(line)
+#define NASH_PHASE(phase) PhaseTimer NASH_PHASE_NAME(__LINE__)(phase)
+
+// Count every heap allocation of a thread that has a telemetry block
+void* countedAllocation(std::size_t bytes) {
+    if (Telemetry::ThreadBlock* block = Telemetry::current()) {
+        block->add(COUNT_ALLOCATIONS, 1);
+        block->add(COUNT_ALLOCATED_BYTES, bytes);
+    }
+    void* memory = std::malloc(bytes == 0 ? 1 : bytes);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* countedAllocation(std::size_t bytes, std::align_val_t alignment) {
+    if (Telemetry::ThreadBlock* block = Telemetry::current()) {
+        block->add(COUNT_ALLOCATIONS, 1);
+        block->add(COUNT_ALLOCATED_BYTES, bytes);
+    }
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+#ifdef _WIN32
+    void* memory = _aligned_malloc(bytes == 0 ? 1 : bytes, align);
+#else
+    void* memory = nullptr;
+    if (posix_memalign(&memory, align, bytes == 0 ? 1 : bytes) != 0) memory = nullptr;
+#endif
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void alignedFree(void* memory) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void* operator new(std::size_t bytes) { return countedAllocation(bytes); }
+void* operator new[](std::size_t bytes) { return countedAllocation(bytes); }
+void* operator new(std::size_t bytes, std::align_val_t alignment) { return countedAllocation(bytes, alignment); }
+void* operator new[](std::size_t bytes, std::align_val_t alignment) { return countedAllocation(bytes, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { alignedFree(memory); }
+#else
+#define NASH_COUNT(counter) ((void)0)
+#define NASH_PHASE(phase) ((void)0)
+#endif
 
 // Abstract Player class
+// Limits on the work a search player may spend on one move. A zero field
+// means no limit; with both fields zero the player uses its default amount.
+struct SearchBudget {
+    long long playouts = 0;     // Playouts (or iterations) per move
+    int timeMs = 0;             // Wall-clock time per move in milliseconds
+};
+
+// What the most recent search of a player did
+struct SearchStats {
+    long long playouts = 0;     // Playouts completed (nodes for alpha-beta)
+    double seconds = 0.0;       // Wall-clock time spent
+    long long tableHits = 0;    // Transposition table lookups that found an entry
+    int depth = 0;              // Deepest completed iteration (alpha-beta)
+    double branchingFactor = 0.0;   // Nodes of that iteration / nodes of the one before
+    bool fromBook = false;      // The move came from the opening book
+};
+
 class Player {
 public:
     virtual std::pair<int, int> getMove() = 0;
+    
+    // Statistics of the last getMove, or nullptr for players that do not search
+    virtual const SearchStats* getSearchStats() const {
+        return nullptr;
+    }
+    
     virtual ~Player() {}
 };
 
+// Base class for anytime search players: keeps the budget, the clock and the
+// statistics of the last search
+class SearchPlayer : public Player {
+protected:
+    SearchBudget budget;
+    SearchStats stats;
+    std::chrono::steady_clock::time_point searchStart;
+    bool capturedFill = true;   // Fill captured pairs for their captor before searching
+    
+    void startSearch() {
+        stats = SearchStats();
+        searchStart = std::chrono::steady_clock::now();
+    }
+    
+    double elapsedSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - searchStart).count();
+    }
+    
+    // True once the wall-clock budget (if any) has been used up
+    bool outOfTime() const {
+        return budget.timeMs > 0 && elapsedSeconds() * 1000.0 >= budget.timeMs;
+    }
+    
+    void finishSearch() {
+        stats.seconds = elapsedSeconds();
+    }
+    
+public:
+    void setBudget(const SearchBudget& value) {
+        budget = value;
+    }
+    
+    // Enable or disable filling captured pairs (on by default)
+    void setCapturedFill(bool enabled) {
+        capturedFill = enabled;
+    }
+    
+    const SearchStats* getSearchStats() const override {
+        return &stats;
+    }
+};
+
 // Board class to represent the Nash game board
 class Board {
 private:
-    int size;                      // Size of the board (n x n)
-    std::vector<std::vector<int>> board;  // 2D array to store the board state
+    int size;                           // Size of the board (n x n)
+    const BoardGeometry* geometry;      // Shared masks for this board size
+    alignas(64) uint64_t white[MAX_WORDS];      // Bitboard of White's stones, cache-line aligned
+    alignas(64) uint64_t black[MAX_WORDS];      // Bitboard of Black's stones
+    uint64_t hash;                      // Zobrist hash of the stones on the board
+    int whiteScore;                     // evaluatePosition(1), kept up to date by makeMove
+    int blackScore;                     // evaluatePosition(-1)
+    
+    // Incremental connectivity: a disjoint-set over the cells plus four virtual
+    // edge nodes (left, right, top, bottom at indices n*n .. n*n+3). Union by
+    // rank without path compression keeps every union undoable from the log.
+    int16_t parent[MAX_CELLS + 4];
+    uint8_t rank[MAX_CELLS + 4];
+    int16_t unionLog[MAX_CELLS + 4];    // Absorbed root * 2 + (1 if rank grew)
+    int logSize;
+    int16_t moveStack[MAX_CELLS];       // Occupied cells in placement order
+    int16_t logStart[MAX_CELLS];        // unionLog size before each placement
+    int moveCount;
+    
+    // The empty cells as a dense list in no particular order, and each cell's
+    // slot in it. A placement moves the last entry into the stone's slot; an
+    // undo puts it back, so the order is restored exactly. An occupied cell
+    // keeps the slot it was taken from.
+    int16_t emptyList[MAX_CELLS];
+    int16_t emptySlot[MAX_CELLS];
+    
+    // Scratch space for hasWonByDfs, reused between calls and never copied
+    mutable int16_t dfsStack[MAX_CELLS];
+    mutable uint64_t dfsVisited[MAX_WORDS];
 
 public:
     // Constructor
-    Board(int n) : size(n) {
-        // Initialize the board with all cells empty (0)
-        board.resize(n, std::vector<int>(n, 0));
+    Board(int n) : size(n), geometry(&BoardGeometry::forSize(n)), hash(0),
+                 whiteScore(0), blackScore(0), logSize(0), moveCount(0) {
+        // Initialize the board with all cells empty
+        std::fill(white, white + geometry->numWords, 0);
+        std::fill(black, black + geometry->numWords, 0);
+        for (int i = 0; i < geometry->numCells + 4; i++) {
+            parent[i] = static_cast<int16_t>(i);
+            rank[i] = 0;
+        }
+        resetEmptyList();
     }
     
-    // Copy constructor
-    Board(const Board& other) : size(other.size), board(other.board) {}
+    // Copy constructor (copies only the entries in use, never allocates)
+    Board(const Board& other) : size(other.size), geometry(other.geometry) {
+        copyFrom(other);
+    }
     
     // Assignment operator
     Board& operator=(const Board& other) {
         if (this != &other) {
             size = other.size;
-            board = other.board;
+            geometry = other.geometry;
+            copyFrom(other);
         }
         return *this;
     }
@@ -59,23 +1178,90 @@ public:
         return size;
     }
     
-    // Get the value at a specific position
-    int getValue(int x, int y) const {
-        if (x >= 0 && x < size && y >= 0 && y < size) {
-            return board[x][y];
-        }
-        return -999; // Invalid position
+    // Get the shared masks for this board size
+    const BoardGeometry& getGeometry() const {
+        return *geometry;
     }
     
-    // Check if a move is valid
-    bool isValidMove(int x, int y) const {
-        return x >= 0 && x < size && y >= 0 && y < size && board[x][y] == 0;
+    // Get the number of stones on the board
+    int getStoneCount() const {
+        return moveCount;
     }
     
-    // Make a move on the board
-    bool makeMove(int x, int y, int playerType) {
+    // Get the Zobrist hash of the current position (0 for the empty board)
+    uint64_t getHash() const {
+        return hash;
+    }
+    
+    // Get the bitboard of one player's stones (1: White, -1: Black)
+    const uint64_t* getStones(int playerType) const {
+        return playerType == 1 ? white : black;
+    }
+    
+    // Number of empty cells
+    int getEmptyCount() const {
+        return geometry->numCells - moveCount;
+    }
+    
+    // The getEmptyCount() empty cells (x * size + y), in an order that changes
+    // as moves are made and undone; valid until the next change to the board
+    const int16_t* getEmptyList() const {
+        return emptyList;
+    }
+    
+    // Replace the contents of 'cells' with the indices (x * size + y) of all
+    // empty cells, in increasing order
+    void getEmptyCells(std::vector<int>& cells) const {
+        cells.clear();
+        for (int w = 0; w < geometry->numWords; w++) {
+            uint64_t empty = ~(white[w] | black[w]);
+            while (empty) {
+                int cell = w * 64 + __builtin_ctzll(empty);
+                if (cell >= geometry->numCells) break;
+                cells.push_back(cell);
+                empty &= empty - 1;
+            }
+        }
+    }
+    
+    // Get the value at a specific position
+    int getValue(int x, int y) const {
+        if (x >= 0 && x < size && y >= 0 && y < size) {
+            int index = x * size + y;
+            if (testBit(white, index)) return 1;
+            if (testBit(black, index)) return -1;
+            return 0;
+        }
+        return -999; // Invalid position
+    }
+    
+    // Check if a move is valid
+    bool isValidMove(int x, int y) const {
+        return getValue(x, y) == 0;
+    }
+    
+    // Make a move on the board
+    // A playerType of 0 clears an occupied cell, which undoes a temporary move.
+    // Undoing the most recent move is O(1) amortised; any other cell triggers
+    // a rebuild of the connectivity structure.
+    bool makeMove(int x, int y, int playerType) {
+        if (playerType == 0) {
+            if (getValue(x, y) == 1 || getValue(x, y) == -1) {
+                NASH_COUNT(COUNT_UNDOS);
+                removeStone(x * size + y);
+                return true;
+            }
+            return false;
+        }
         if (isValidMove(x, y)) {
-            board[x][y] = playerType;
+            NASH_COUNT(COUNT_MOVES);
+            setBit(playerType == 1 ? white : black, x * size + y);
+            hash ^= ZobristKeys::instance().key(x * size + y, playerType);
+            updateScores(x * size + y, playerType, 1);
+            takeEmpty(x * size + y);
+            logStart[moveCount] = static_cast<int16_t>(logSize);
+            moveStack[moveCount++] = static_cast<int16_t>(x * size + y);
+            connectStone(x, y, playerType);
             return true;
         }
         return false;
@@ -101,9 +1287,10 @@ public:
         for (int i = 0; i < size; i++) {
             std::cout << i + 1 << "|";
             for (int j = 0; j < size; j++) {
-                if (board[i][j] == 0) {
+                int value = getValue(i, j);
+                if (value == 0) {
                     std::cout << " ";
-                } else if (board[i][j] == 1) {
+                } else if (value == 1) {
                     std::cout << "W";
                 } else {
                     std::cout << "B";
@@ -121,407 +1308,2584 @@ public:
         }
     }
     
-    // Task 1: Check if the board is full
-    bool isFull() const {
-        for (int i = 0; i < size; i++) {
-            for (int j = 0; j < size; j++) {
-                if (board[i][j] == 0) {
-                    return false;
-                }
-            }
+    // Task 1: Check if the board is full
+    // Every placement and removal updates the stone count, so this is O(1)
+    bool isFull() const {
+        return moveCount == geometry->numCells;
+    }
+    
+    // Task 3: Check if a player has a complete straight line
+    // White needs a whole row, Black a whole column
+    bool hasCompleteLineWin(int playerType) const {
+        if (playerType != 1 && playerType != -1) return false;
+        return geometry->kernels->hasLine(*geometry, getStones(playerType), playerType);
+    }
+    
+    // Task 4: Get neighbors of a cell with the same player's stones
+    // Neighbours come from the per-size table in BoardGeometry, in DX/DY order
+    NeighbourList getNeighbours(int playerType, int x, int y) const {
+        NeighbourList neighbors;
+        const int cell = x * size + y;
+        const int16_t* table = geometry->neighboursOf(cell);
+        const uint64_t* stones = getStones(playerType);
+        for (int i = 0; i < geometry->neighbourCount[cell]; i++) {
+            if (testBit(stones, table[i])) {
+                neighbors.push(table[i] / size, table[i] % size);
+            }
+        }
+        return neighbors;
+    }
+    
+    // Print all neighbors of a cell with the same player's stones
+    void printNeighbours(int x, int y) {
+        int playerType = getValue(x, y);
+        if (playerType == 0) {
+            std::cout << "Cell (" << x + 1 << "," << y + 1 << ") is empty." << std::endl;
+            return;
+        }
+        
+        NeighbourList neighbors = getNeighbours(playerType, x, y);
+        std::cout << "Neighbors of (" << x + 1 << "," << y + 1 << ") with " 
+                  << (playerType == 1 ? "White" : "Black") << " stones:" << std::endl;
+        
+        if (neighbors.empty()) {
+            std::cout << "No neighbors with the same stone." << std::endl;
+            return;
+        }
+        
+        // Last found first, the order the output has always used
+        for (int i = neighbors.size() - 1; i >= 0; i--) {
+            std::pair<int, int> pos = neighbors[i];
+            std::cout << "(" << pos.first + 1 << "," << pos.second + 1 << ") ";
+        }
+        std::cout << std::endl;
+    }
+    
+    // Task 5: Check if a player has won
+    // The disjoint-set is updated by every makeMove, so this only has to ask
+    // whether the player's two virtual edge nodes share a root
+    bool hasWon(int playerType) const {
+        NASH_COUNT(COUNT_WIN_CHECKS);
+        // White (1) connects left to right, Black (-1) connects top to bottom
+        int n2 = geometry->numCells;
+        if (playerType == 1) {
+            return findRoot(n2) == findRoot(n2 + 1);
+        } else if (playerType == -1) {
+            return findRoot(n2 + 2) == findRoot(n2 + 3);
+        }
+        return false;
+    }
+    
+    // Win check by word-parallel flood fill, independent of the disjoint-set
+    bool hasWonByFloodFill(int playerType) const {
+        if (playerType == 1) {
+            return connects(white, geometry->leftEdge, geometry->rightEdge);
+        } else if (playerType == -1) {
+            return connects(black, geometry->topEdge, geometry->bottomEdge);
+        }
+        return false;
+    }
+    
+    // True if 'stones' contain a connected chain touching both 'from' and 'to'
+    bool connects(const uint64_t* stones, const uint64_t* from, const uint64_t* to) const {
+        NASH_COUNT(COUNT_FLOOD_FILLS);
+        return geometry->kernels->connects(*geometry, stones, from, to);
+    }
+    
+    // Connection distance: the fewest empty cells 'playerType' still has to
+    // fill to connect its two edges, or numCells + 1 if the opponent has
+    // already cut every path. Own stones cost nothing to cross and opponent
+    // stones cannot be crossed, so this is a 0-1 shortest path. It is computed
+    // breadth first one distance layer at a time on bitboards: each layer adds
+    // the empty cells next to everything reached so far, then flood fills
+    // through own stones for free. Uses only stack buffers.
+    int connectionDistance(int playerType) const {
+        NASH_COUNT(COUNT_DISTANCES);
+        return geometry->kernels->connectionDistance(*geometry, white, black, playerType);
+    }
+    
+    // Shortest-path evaluation: how many cells closer 'playerType' is to
+    // connecting than the opponent (positive is good for 'playerType')
+    int evaluateConnection(int playerType) const {
+        return connectionDistance(-playerType) - connectionDistance(playerType);
+    }
+    
+    // Win check by depth-first search from every stone on the player's start
+    // edge (reference implementation of Task 5), independent of the disjoint-set
+    bool hasWonByDfs(int playerType) const {
+        NASH_COUNT(COUNT_DFS_SEARCHES);
+        std::fill(dfsVisited, dfsVisited + geometry->numWords, 0);
+        for (int k = 0; k < size; k++) {
+            int x = (playerType == 1) ? k : 0;
+            int y = (playerType == 1) ? 0 : k;
+            if (getValue(x, y) == playerType && !testBit(dfsVisited, x * size + y)
+                && dfsPathFinding(playerType, x, y)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // DFS algorithm to find a winning path from (x, y)
+    // Iterative with an explicit stack, so even a chain snaking through every
+    // cell of the largest board cannot overflow the call stack. The stack and
+    // visited set are preallocated in the board and shared by the calls of one
+    // hasWonByDfs, so cells explored from an earlier start are not revisited.
+    bool dfsPathFinding(int playerType, int x, int y) const {
+        const uint64_t* stones = getStones(playerType);
+        int top = 0;
+        dfsStack[top++] = static_cast<int16_t>(x * size + y);
+        setBit(dfsVisited, x * size + y);
+        
+        while (top > 0) {
+            int cell = dfsStack[--top];
+            
+            // If White player reaches rightmost column or Black player reaches bottom row
+            if ((playerType == 1 && cell % size == size - 1) || (playerType == -1 && cell / size == size - 1)) {
+                return true;
+            }
+            
+            // Push all unvisited neighbours with the same player's stones
+            const int16_t* table = geometry->neighboursOf(cell);
+            for (int i = 0; i < geometry->neighbourCount[cell]; i++) {
+                int next = table[i];
+                if (testBit(stones, next) && !testBit(dfsVisited, next)) {
+                    setBit(dfsVisited, next);
+                    dfsStack[top++] = static_cast<int16_t>(next);
+                }
+            }
+        }
+        
+        return false;
+    }
+
+    // For Smart Player: Evaluate board position
+    // Stones count more the further they are toward the player's goal edge:
+    // own stones add column + 1 (White) or row + 1 (Black), opponent stones
+    // subtract the same. The sums are updated by every move and undo, so this is O(1).
+    int evaluatePosition(int playerType) const {
+        NASH_COUNT(COUNT_EVALUATIONS);
+        return playerType == 1 ? whiteScore : blackScore;
+    }
+
+private:
+    void copyFrom(const Board& other) {
+        NASH_COUNT(COUNT_BOARD_COPIES);
+        const int numNodes = geometry->numCells + 4;
+        std::copy(other.white, other.white + geometry->numWords, white);
+        std::copy(other.black, other.black + geometry->numWords, black);
+        hash = other.hash;
+        whiteScore = other.whiteScore;
+        blackScore = other.blackScore;
+        std::copy(other.parent, other.parent + numNodes, parent);
+        std::copy(other.rank, other.rank + numNodes, rank);
+        std::copy(other.unionLog, other.unionLog + other.logSize, unionLog);
+        std::copy(other.moveStack, other.moveStack + other.moveCount, moveStack);
+        std::copy(other.logStart, other.logStart + other.moveCount, logStart);
+        std::copy(other.emptyList, other.emptyList + geometry->numCells - other.moveCount, emptyList);
+        std::copy(other.emptySlot, other.emptySlot + geometry->numCells, emptySlot);
+        logSize = other.logSize;
+        moveCount = other.moveCount;
+    }
+    
+    void resetEmptyList() {
+        for (int i = 0; i < geometry->numCells; i++) {
+            emptyList[i] = static_cast<int16_t>(i);
+            emptySlot[i] = static_cast<int16_t>(i);
+        }
+    }
+    
+    // Remove 'cell' from the empty list (called before moveCount grows)
+    void takeEmpty(int cell) {
+        int slot = emptySlot[cell];
+        int last = emptyList[geometry->numCells - moveCount - 1];
+        emptyList[slot] = static_cast<int16_t>(last);
+        emptySlot[last] = static_cast<int16_t>(slot);
+    }
+    
+    // Undo the takeEmpty of the most recent stone (called after moveCount shrank)
+    void restoreEmpty(int cell) {
+        int slot = emptySlot[cell];
+        int end = geometry->numCells - moveCount - 1;
+        int moved = emptyList[slot];
+        emptyList[end] = static_cast<int16_t>(moved);
+        emptySlot[moved] = static_cast<int16_t>(end);
+        emptyList[slot] = static_cast<int16_t>(cell);
+        emptySlot[cell] = static_cast<int16_t>(slot);
+    }
+    
+    // Add (sign 1) or remove (sign -1) one stone's contribution to both scores
+    void updateScores(int cell, int playerType, int sign) {
+        int x = cell / size;
+        int y = cell % size;
+        whiteScore += sign * playerType * (y + 1);
+        blackScore -= sign * playerType * (x + 1);
+    }
+    
+    int findRoot(int node) const {
+        while (parent[node] != node) {
+            node = parent[node];
+        }
+        return node;
+    }
+    
+    void unite(int a, int b) {
+        int rootA = findRoot(a);
+        int rootB = findRoot(b);
+        if (rootA == rootB) return;
+        if (rank[rootA] < rank[rootB]) std::swap(rootA, rootB);
+        bool rankGrew = rank[rootA] == rank[rootB];
+        parent[rootB] = static_cast<int16_t>(rootA);
+        if (rankGrew) rank[rootA]++;
+        unionLog[logSize++] = static_cast<int16_t>(rootB * 2 + (rankGrew ? 1 : 0));
+    }
+    
+    // Join a newly placed stone with same-coloured neighbours and its goal edges
+    void connectStone(int x, int y, int playerType) {
+        int cell = x * size + y;
+        int n2 = geometry->numCells;
+        for (int i = 0; i < 6; i++) {
+            int nx = x + DX[i];
+            int ny = y + DY[i];
+            if (getValue(nx, ny) == playerType) {
+                unite(cell, nx * size + ny);
+            }
+        }
+        if (playerType == 1) {
+            if (y == 0) unite(cell, n2);
+            if (y == size - 1) unite(cell, n2 + 1);
+        } else {
+            if (x == 0) unite(cell, n2 + 2);
+            if (x == size - 1) unite(cell, n2 + 3);
+        }
+    }
+    
+    void removeStone(int cell) {
+        hash ^= ZobristKeys::instance().key(cell, testBit(white, cell) ? 1 : -1);
+        updateScores(cell, testBit(white, cell) ? 1 : -1, -1);
+        clearBit(white, cell);
+        clearBit(black, cell);
+        if (moveCount > 0 && moveStack[moveCount - 1] == cell) {
+            // Undo the most recent placement by replaying its unions backwards
+            moveCount--;
+            restoreEmpty(cell);
+            while (logSize > logStart[moveCount]) {
+                int entry = unionLog[--logSize];
+                int absorbed = entry >> 1;
+                if (entry & 1) rank[parent[absorbed]]--;
+                parent[absorbed] = static_cast<int16_t>(absorbed);
+            }
+            return;
+        }
+        
+        // Out-of-order removal: replay the remaining stones in their original
+        // order so each one is only joined with stones placed before it
+        uint64_t oldWhite[MAX_WORDS];
+        std::copy(white, white + geometry->numWords, oldWhite);
+        std::fill(white, white + geometry->numWords, 0);
+        std::fill(black, black + geometry->numWords, 0);
+        for (int i = 0; i < geometry->numCells + 4; i++) {
+            parent[i] = static_cast<int16_t>(i);
+            rank[i] = 0;
+        }
+        int oldCount = moveCount;
+        moveCount = 0;
+        logSize = 0;
+        resetEmptyList();
+        for (int i = 0; i < oldCount; i++) {
+            int stone = moveStack[i];
+            if (stone == cell) continue;
+            int playerType = testBit(oldWhite, stone) ? 1 : -1;
+            setBit(playerType == 1 ? white : black, stone);
+            takeEmpty(stone);
+            logStart[moveCount] = static_cast<int16_t>(logSize);
+            moveStack[moveCount++] = static_cast<int16_t>(stone);
+            connectStone(stone / size, stone % size, playerType);
+        }
+    }
+};
+
+// Patterns
+// Local shapes around a cell, read from the RING neighbours of BoardGeometry.
+// Off-board neighbours count as stones of the player who owns that edge, so
+// the same tests also cover the edge templates built from them.
+
+// Owner of a ring entry given both players' stones: 1, -1, or 0 for an empty
+// cell or a corner
+inline int ringOwner(int entry, const uint64_t* white, const uint64_t* black) {
+    if (entry >= 0) {
+        if (testBit(white, entry)) return 1;
+        if (testBit(black, entry)) return -1;
+        return 0;
+    }
+    if (entry == RING_WHITE_EDGE) return 1;
+    if (entry == RING_BLACK_EDGE) return -1;
+    return 0;
+}
+
+// A cell is dead if four consecutive neighbours around it belong to one
+// player. Those four are already connected through each other, and the two
+// remaining neighbours touch them and each other. A stone of either colour
+// there therefore connects nothing new, and the outcome never depends on who
+// fills it, so search can skip the cell.
+inline bool isDeadCell(const BoardGeometry& geometry, const uint64_t* white, const uint64_t* black, int cell) {
+    const int16_t* ring = &geometry.ring[cell * 6];
+    int owners[6];
+    for (int r = 0; r < 6; r++) {
+        owners[r] = ringOwner(ring[r], white, black);
+    }
+    for (int start = 0; start < 6; start++) {
+        int owner = owners[start];
+        if (owner != 0 && owners[(start + 1) % 6] == owner && owners[(start + 2) % 6] == owner
+            && owners[(start + 3) % 6] == owner) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool isDeadCell(const Board& board, int cell) {
+    return isDeadCell(board.getGeometry(), board.getStones(1), board.getStones(-1), cell);
+}
+
+// Two-bridge: two of a player's stones (or a stone and its edge) that share
+// two empty neighbours are connected, because an intrusion into one shared
+// cell is answered with the other. When 'cell' has just been taken by the
+// opponent of 'defender', return the other shared cell of a bridge it broke
+// into, or -1 if it broke into none.
+inline int findBridgeSave(const BoardGeometry& geometry, const uint64_t* white, const uint64_t* black,
+                          int cell, int defender) {
+    const int16_t* ring = &geometry.ring[cell * 6];
+    const uint64_t* own = defender == 1 ? white : black;
+    const int ownEdge = defender == 1 ? RING_WHITE_EDGE : RING_BLACK_EDGE;
+    
+    // One bit per ring position: held by the defender (stone or edge), empty cell, stone
+    int held = 0;
+    int empty = 0;
+    int stone = 0;
+    for (int r = 0; r < 6; r++) {
+        int entry = ring[r];
+        if (entry >= 0) {
+            if (testBit(own, entry)) {
+                held |= 1 << r;
+                stone |= 1 << r;
+            } else if (!testBit(white, entry) && !testBit(black, entry)) {
+                empty |= 1 << r;
+            }
+        } else if (entry == ownEdge) {
+            held |= 1 << r;
+        }
+    }
+    if (stone == 0) return -1;
+    
+    // Positions r and r + 2 held with r + 1 empty; at least one end must be a stone
+    for (int r = 0; r < 6; r++) {
+        int first = 1 << r;
+        int second = 1 << ((r + 2) % 6);
+        if ((held & first) && (held & second) && (empty & (1 << ((r + 1) % 6)))
+            && ((stone & first) || (stone & second))) {
+            return ring[(r + 1) % 6];
+        }
+    }
+    return -1;
+}
+
+inline int findBridgeSave(const Board& board, int cell, int defender) {
+    return findBridgeSave(board.getGeometry(), board.getStones(1), board.getStones(-1), cell, defender);
+}
+
+// True if, once ring position 'taken' around a cell holds a stone of
+// 'player', four consecutive ring positions including it belong to 'player'
+inline bool deadOnceTaken(const int* owners, int taken, int player) {
+    for (int start = taken - 3; start <= taken; start++) {
+        bool held = true;
+        for (int k = 0; k < 4 && held; k++) {
+            int r = (start + k + 6) % 6;
+            held = r == taken || owners[r] == player;
+        }
+        if (held) return true;
+    }
+    return false;
+}
+
+// Captured pair: two adjacent empty cells, each of which would be dead if the
+// other held a stone of the captor. If the opponent takes one, the captor
+// takes the other and the opponent's stone connects nothing, so the captor
+// may fill both before searching without changing the outcome. Returns the
+// captor (1 or -1) and sets 'partner' if 'cell' is in such a pair, else 0.
+inline int findCapturedPair(const BoardGeometry& geometry, const uint64_t* white, const uint64_t* black,
+                            int cell, int& partner) {
+    const int16_t* ring = &geometry.ring[cell * 6];
+    int owners[6];
+    for (int r = 0; r < 6; r++) {
+        owners[r] = ringOwner(ring[r], white, black);
+    }
+    for (int r = 0; r < 6; r++) {
+        int other = ring[r];
+        if (other < 0 || testBit(white, other) || testBit(black, other)) continue;
+        const int16_t* otherRing = &geometry.ring[other * 6];
+        int otherOwners[6];
+        int back = -1;
+        for (int k = 0; k < 6; k++) {
+            otherOwners[k] = ringOwner(otherRing[k], white, black);
+            if (otherRing[k] == cell) back = k;
+        }
+        for (int captor : {1, -1}) {
+            if (deadOnceTaken(owners, r, captor) && deadOnceTaken(otherOwners, back, captor)) {
+                partner = other;
+                return captor;
+            }
+        }
+    }
+    return 0;
+}
+
+// Fill every captured pair with stones of its captor, repeating while new
+// pairs appear, and return the number of stones added. A pair whose fill
+// would decide the game or fill the board is left empty, so the result is
+// always a position with moves to search.
+inline int fillCapturedCells(Board& board) {
+    const int size = board.getSize();
+    const int numCells = size * size;
+    int filled = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int cell = 0; cell < numCells; cell++) {
+            if (board.getValue(cell / size, cell % size) != 0) continue;
+            int partner;
+            int captor = findCapturedPair(board.getGeometry(), board.getStones(1), board.getStones(-1), cell, partner);
+            if (captor == 0) continue;
+            board.makeMove(cell / size, cell % size, captor);
+            board.makeMove(partner / size, partner % size, captor);
+            if (board.hasWon(captor) || board.getEmptyCount() == 0) {
+                board.makeMove(partner / size, partner % size, 0);
+                board.makeMove(cell / size, cell % size, 0);
+                return filled;
+            }
+            filled += 2;
+            changed = true;
+        }
+    }
+    return filled;
+}
+
+// Replace 'cells' with the empty cells that are not dead; if every empty cell
+// is dead, all of them, so there is always a move to choose from
+inline void getLiveCells(const Board& board, std::vector<int>& cells) {
+    board.getEmptyCells(cells);
+    size_t live = 0;
+    for (size_t i = 0; i < cells.size(); i++) {
+        if (!isDeadCell(board, cells[i])) {
+            cells[live++] = cells[i];
+        }
+    }
+    if (live > 0) {
+        cells.resize(live);
+    }
+}
+
+// Fixed-size transposition table indexed by Zobrist hash. Each slot holds a
+// 64-bit payload whose meaning is up to the player using the table; a payload
+// of 0 marks an empty slot. The key is stored XORed with the payload, so if
+// two threads write the same slot at once the mixed result fails the key
+// check instead of being returned, and slots need no lock. New entries always
+// replace old ones.
+class TranspositionTable {
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;    // key ^ data
+        std::atomic<uint64_t> data;
+    };
+    
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+    
+public:
+    // A table of 2^log2Slots slots (16 bytes each)
+    explicit TranspositionTable(int log2Slots) : slots(new Slot[1ULL << log2Slots]), mask((1ULL << log2Slots) - 1) {
+        clear();
+    }
+    
+    // Look up 'key'; on a hit, store its payload in 'data'
+    bool probe(uint64_t key, uint64_t& data) const {
+        const Slot& slot = slots[key & mask];
+        uint64_t value = slot.data.load(std::memory_order_relaxed);
+        if (value == 0 || (slot.check.load(std::memory_order_relaxed) ^ value) != key) {
+            return false;
+        }
+        data = value;
+        return true;
+    }
+    
+    void store(uint64_t key, uint64_t data) {
+        Slot& slot = slots[key & mask];
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+        slot.data.store(data, std::memory_order_relaxed);
+    }
+    
+    void clear() {
+        for (uint64_t i = 0; i <= mask; i++) {
+            slots[i].check.store(0, std::memory_order_relaxed);
+            slots[i].data.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    size_t size() const {
+        return static_cast<size_t>(mask + 1);
+    }
+};
+
+// Random playout engine for Monte Carlo players
+// Hex cannot end in a draw and a full board has exactly one winner, so a
+// random game never needs to be played move by move: the empty cells are
+// shuffled, split between the two colours in turn order, and a single
+// connectivity check on the filled board decides the winner. The RNG and
+// scratch buffers live in the engine and are reused across playouts.
+// With bridge responses enabled the cells are handed out alternately in
+// shuffled order, except that a move breaking into a bridge of the other
+// player is answered by that player taking the bridge's other cell.
+class PlayoutEngine {
+private:
+    Rng rng;
+    bool bridgeResponses;               // Use the bridge-aware fill
+    std::vector<int> emptyCells;        // Empty cells of the position being simulated
+    uint64_t filledWhite[MAX_WORDS];    // White's stones after the last fill
+    uint64_t filledBlack[MAX_WORDS];    // Black's stones during a bridge-aware fill
+    int16_t positionOf[MAX_CELLS];      // Index of each cell in emptyCells during that fill
+    int whiteCells;                     // Leading entries of emptyCells White got in the last fill
+    
+public:
+    explicit PlayoutEngine(unsigned int seed) : rng(seed), bridgeResponses(true), whiteCells(0) {
+        emptyCells.reserve(MAX_CELLS);
+    }
+    
+    void seed(unsigned int value) {
+        rng.seed(value);
+    }
+    
+    // Enable or disable bridge responses in playouts (on by default)
+    void setBridgeResponses(bool enabled) {
+        bridgeResponses = enabled;
+    }
+    
+    // Play 'count' random games from 'board' with 'toMove' moving first and
+    // return how many of them 'playerType' won
+    int runPlayouts(const Board& board, int toMove, int count, int playerType) {
+        NASH_PHASE(PHASE_PLAYOUTS);
+        loadEmptyCells(board);
+        int wins = 0;
+        for (int i = 0; i < count; i++) {
+            if (fillAndScore(board, toMove) == playerType) {
+                wins++;
+            }
+        }
+        return wins;
+    }
+    
+    // Same as above, and also collect All-Moves-As-First statistics: in every
+    // playout each empty cell 'playerType' filled counts as a visit, and as a
+    // win if 'playerType' won. Both arrays are indexed by cell and added to.
+    int runPlayouts(const Board& board, int toMove, int count, int playerType,
+                    int* amafWins, int* amafVisits) {
+        NASH_PHASE(PHASE_PLAYOUTS);
+        loadEmptyCells(board);
+        const int numEmpty = static_cast<int>(emptyCells.size());
+        int wins = 0;
+        for (int i = 0; i < count; i++) {
+            bool won = fillAndScore(board, toMove) == playerType;
+            int first = (playerType == 1) ? 0 : whiteCells;
+            int last = (playerType == 1) ? whiteCells : numEmpty;
+            for (int k = first; k < last; k++) {
+                amafVisits[emptyCells[k]]++;
+                if (won) amafWins[emptyCells[k]]++;
+            }
+            if (won) wins++;
+        }
+        return wins;
+    }
+    
+    // Play one random game from 'board' and return the winner (1 or -1)
+    int playout(const Board& board, int toMove) {
+        NASH_PHASE(PHASE_PLAYOUTS);
+        loadEmptyCells(board);
+        return fillAndScore(board, toMove);
+    }
+    
+    // White's stones on the full board produced by the last playout
+    const uint64_t* getFilledWhite() const {
+        return filledWhite;
+    }
+    
+private:
+    // Start from the board's own empty-cell list; playouts shuffle it anyway,
+    // so its order does not matter
+    void loadEmptyCells(const Board& board) {
+        emptyCells.assign(board.getEmptyList(), board.getEmptyList() + board.getEmptyCount());
+    }
+    
+    // Give a random half of the empty cells to each player and score the result
+    int fillAndScore(const Board& board, int toMove) {
+        NASH_COUNT(COUNT_PLAYOUTS);
+        if (bridgeResponses) {
+            return fillWithBridgeResponses(board, toMove);
+        }
+        const BoardGeometry& geometry = board.getGeometry();
+        const int numEmpty = static_cast<int>(emptyCells.size());
+        
+        // The player to move gets the extra cell when the count is odd
+        whiteCells = (toMove == 1) ? (numEmpty + 1) / 2 : numEmpty / 2;
+        
+        // Partial Fisher-Yates: the first whiteCells entries become White's
+        std::copy(board.getStones(1), board.getStones(1) + geometry.numWords, filledWhite);
+        for (int i = 0; i < whiteCells; i++) {
+            int pick = i + static_cast<int>(randomBelow(rng, static_cast<uint32_t>(numEmpty - i)));
+            std::swap(emptyCells[i], emptyCells[pick]);
+            setBit(filledWhite, emptyCells[i]);
+        }
+        
+        // On a full board Black wins exactly when White does not
+        return board.connects(filledWhite, geometry.leftEdge, geometry.rightEdge) ? 1 : -1;
+    }
+    
+    // Fill move by move, alternating from 'toMove'; each move is a random
+    // remaining cell unless the previous move broke into one of the mover's
+    // bridges, in which case the mover saves it
+    int fillWithBridgeResponses(const Board& board, int toMove) {
+        const BoardGeometry& geometry = board.getGeometry();
+        const int numEmpty = static_cast<int>(emptyCells.size());
+        std::copy(board.getStones(1), board.getStones(1) + geometry.numWords, filledWhite);
+        std::copy(board.getStones(-1), board.getStones(-1) + geometry.numWords, filledBlack);
+        for (int i = 0; i < numEmpty; i++) {
+            positionOf[emptyCells[i]] = static_cast<int16_t>(i);
+        }
+        
+        int player = toMove;
+        int save = -1;
+        for (int i = 0; i < numEmpty; i++) {
+            int pick = save >= 0 ? positionOf[save]
+                                 : i + static_cast<int>(randomBelow(rng, static_cast<uint32_t>(numEmpty - i)));
+            int cell = emptyCells[pick];
+            emptyCells[pick] = emptyCells[i];
+            emptyCells[i] = cell;
+            positionOf[emptyCells[pick]] = static_cast<int16_t>(pick);
+            positionOf[cell] = static_cast<int16_t>(i);
+            
+            setBit(player == 1 ? filledWhite : filledBlack, cell);
+            save = findBridgeSave(geometry, filledWhite, filledBlack, cell, -player);
+            player = -player;
+        }
+        
+        // Keep the layout of the plain fill: White's cells first
+        whiteCells = static_cast<int>(std::partition(emptyCells.begin(), emptyCells.end(), [this](int cell) {
+            return testBit(filledWhite, cell);
+        }) - emptyCells.begin());
+        return board.connects(filledWhite, geometry.leftEdge, geometry.rightEdge) ? 1 : -1;
+    }
+};
+
+// Fixed-size pool of worker threads with one task queue per worker.
+// run() deals task indices round-robin to the queues; each worker takes
+// tasks from the back of its own queue and, once it is empty, steals from
+// the front of the others, so uneven tasks balance out. The calling thread
+// acts as worker 0, so a pool of size 1 starts no threads at all.
+// A run allocates nothing once the queues have grown to the largest task
+// count: the task is called through a plain function pointer rather than a
+// std::function, and queues keep their storage between runs.
+class ThreadPool {
+private:
+    // Tasks[head, end) are pending; the owner takes from the back, thieves
+    // from the head
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<int> tasks;
+        size_t head = 0;
+    };
+    
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    void (*current)(const void*, int, int);    // Calls the task of the current run
+    const void* currentTask;
+    std::atomic<int> remaining;
+    int generation;
+    bool stopping;
+    
+public:
+    explicit ThreadPool(int numThreads)
+        : current(nullptr), currentTask(nullptr), remaining(0), generation(0), stopping(false) {
+        if (numThreads < 1) numThreads = 1;
+        for (int i = 0; i < numThreads; i++) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (int i = 1; i < numThreads; i++) {
+            threads.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    int size() const {
+        return static_cast<int>(queues.size());
+    }
+    
+    // Call task(taskIndex, workerIndex) for every index in [0, numTasks) and
+    // return once all of them have finished
+    template <typename Task>
+    void run(int numTasks, const Task& task) {
+        if (numTasks <= 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = [](const void* context, int taskIndex, int worker) {
+                (*static_cast<const Task*>(context))(taskIndex, worker);
+            };
+            currentTask = &task;
+            remaining = numTasks;
+            // Every queue is empty between runs
+            for (const auto& queue : queues) {
+                std::lock_guard<std::mutex> queueLock(queue->mutex);
+                queue->tasks.clear();
+                queue->tasks.reserve(numTasks / queues.size() + 1);
+                queue->head = 0;
+            }
+            for (int i = 0; i < numTasks; i++) {
+                WorkQueue& queue = *queues[i % queues.size()];
+                std::lock_guard<std::mutex> queueLock(queue.mutex);
+                queue.tasks.push_back(i);
+            }
+            generation++;
+        }
+        wake.notify_all();
+        drain(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return remaining == 0; });
+    }
+    
+private:
+    void workerLoop(int worker) {
+        int seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            drain(worker);
+        }
+    }
+    
+    void drain(int worker) {
+        int task;
+        while (nextTask(worker, task)) {
+            current(currentTask, task, worker);
+            if (--remaining == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+    
+    bool nextTask(int worker, int& task) {
+        const int numQueues = static_cast<int>(queues.size());
+        for (int i = 0; i < numQueues; i++) {
+            WorkQueue& queue = *queues[(worker + i) % numQueues];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.head == queue.tasks.size()) continue;
+            if (i == 0) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            } else {
+                task = queue.tasks[queue.head++];
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// Human Player class
+class HumanPlayer : public Player {
+private:
+    Board& board;
+    int playerType;
+    
+public:
+    HumanPlayer(Board& b, int type) : board(b), playerType(type) {}
+    
+    std::pair<int, int> getMove() override {
+        int x, y;
+        std::cout << "Enter your move (row column): ";
+        std::cin >> x >> y;
+        
+        // Convert to 0-indexed
+        x--;
+        y--;
+        
+        // Validate the move
+        while (!board.isValidMove(x, y)) {
+            std::cout << "Invalid move. Try again: ";
+            std::cin >> x >> y;
+            x--;
+            y--;
+        }
+        
+        return {x, y};
+    }
+};
+
+// Task 2: Random Player implementation
+class RandomPlayer : public Player {
+private:
+    Board& board;
+    int playerType;
+    Rng rng;            // Own generator so games can be replayed from a seed
+    
+public:
+    RandomPlayer(Board& b, int type, unsigned int seed = static_cast<unsigned int>(std::time(nullptr)))
+        : board(b), playerType(type), rng(seed) {}
+    
+    std::pair<int, int> getMove() override {
+        // The board keeps a list of its empty cells, so picking one is O(1)
+        int count = board.getEmptyCount();
+        if (count > 0) {
+            int cell = board.getEmptyList()[randomBelow(rng, static_cast<uint32_t>(count))];
+            return {cell / board.getSize(), cell % board.getSize()};
+        }
+        
+        // Fallback (should not happen with proper game termination)
+        return {-1, -1};
+    }
+};
+
+// Evaluation backends for SmartPlayer
+// Positional: stones' progress toward the goal edge plus local connectivity (Task 6)
+// ShortestPath: difference of the two players' connection distances
+enum class SmartEvaluator {
+    Positional,
+    ShortestPath
+};
+
+// Task 6: Smart Player implementation
+class SmartPlayer : public Player {
+private:
+    Board& board;
+    int playerType;
+    SmartEvaluator evaluator;
+    std::vector<int> candidates;    // Scratch list of candidate cells
+    
+public:
+    SmartPlayer(Board& b, int type, SmartEvaluator eval = SmartEvaluator::Positional)
+        : board(b), playerType(type), evaluator(eval) {
+        candidates.reserve(board.getSize() * board.getSize());
+    }
+    
+    // Choose the evaluation backend used for candidate moves
+    void setEvaluator(SmartEvaluator eval) {
+        evaluator = eval;
+    }
+    
+    std::pair<int, int> getMove() override {
+        int size = board.getSize();
+        std::pair<int, int> bestMove = {-1, -1};
+        int bestScore = -999999;
+        
+        // Try each possible move that is not dead and evaluate
+        getLiveCells(board, candidates);
+        for (int cell : candidates) {
+            int i = cell / size;
+            int j = cell % size;
+            
+            // Make temporary move
+            board.makeMove(i, j, playerType);
+            
+            // Evaluate the position after this move
+            int score = evaluateMove(i, j);
+            
+            // Undo the move
+            board.makeMove(i, j, 0);
+            
+            // Update best move if needed
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = {i, j};
+            }
+        }
+        
+        return bestMove;
+    }
+    
+    // Evaluate a move based on various factors
+    int evaluateMove(int x, int y) {
+        NASH_PHASE(PHASE_EVALUATION);
+        int score = 0;
+        int size = board.getSize();
+        
+        // Check if this move would create a win
+        if (board.hasWon(playerType)) {
+            return 10000;  // Very high score for winning move
+        }
+        
+        // Shortest-path backend: connection distance advantage, with ties
+        // going to the cell nearest the centre
+        if (evaluator == SmartEvaluator::ShortestPath) {
+            int centre = size - 1;
+            return board.evaluateConnection(playerType) * 4 * size
+                 - std::abs(2 * x - centre) - std::abs(2 * y - centre);
+        }
+        
+        // Get connected neighbors with the same stone
+        NeighbourList neighbors = board.getNeighbours(playerType, x, y);
+        score += neighbors.size() * 10;  // More neighbors is good
+        
+        // Position-based evaluation
+        if (playerType == 1) {  // White player (left to right)
+            score += y * 5;  // Prefer moves closer to right side
+        } else {  // Black player (top to bottom)
+            score += x * 5;  // Prefer moves closer to bottom
+        }
+        
+        // Use the board's evaluation function
+        score += board.evaluatePosition(playerType);
+        
+        return score;
+    }
+};
+
+// Task 7: Monte Carlo Player implementation
+// Candidate moves are evaluated in rounds: each round runs one batch of
+// playouts per candidate as tasks on a thread pool, and rounds repeat until
+// the playout or time budget is used up. Every worker has its own board copy
+// and playout engine, and each task reseeds the engine from (seed, move
+// number, task), so with a playout budget the chosen move depends only on the
+// seed and never on scheduling.
+// With RAVE enabled every playout also updates All-Moves-As-First statistics
+// for each cell our side filled, and a candidate's score blends its own win
+// rate with the AMAF win rate of its cell, weighted towards AMAF while the
+// candidate has few playouts of its own.
+class MonteCarloPlayer : public SearchPlayer {
+private:
+    Board& board;
+    int playerType;
+    const int SIMULATIONS = 100;  // Default number of simulations per candidate move
+    const int BATCH_SIZE = 10;    // Simulations per candidate per round
+    unsigned int seed;            // Base seed for all playouts
+    int movesPlayed;              // Advances the seed from move to move
+    bool rave;                    // Blend in AMAF statistics
+    const double RAVE_EQUIVALENCE = 1000.0;     // Playouts at which direct and AMAF weigh equally (roughly)
+    ThreadPool pool;
+    std::vector<Board> workerBoards;            // One scratch board per worker
+    std::vector<PlayoutEngine> workerEngines;   // One RNG and buffer set per worker
+    std::vector<std::vector<int>> workerAmafWins;       // Per worker, indexed by cell
+    std::vector<std::vector<int>> workerAmafVisits;
+    
+    // Per-move scratch, one entry per candidate. Sized for every cell up
+    // front and refilled each move, so a search never allocates.
+    std::vector<int> cells;
+    std::vector<std::pair<int, int>> candidates;
+    std::vector<long long> wins;
+    std::vector<long long> playouts;
+    std::vector<int> roundWins;
+    std::vector<int> roundPlayouts;
+    Board searchBoard;                          // The position with captured pairs filled
+    
+public:
+    MonteCarloPlayer(Board& b, int type, int threads = 1,
+                     unsigned int seedValue = static_cast<unsigned int>(std::time(nullptr)))
+        : board(b), playerType(type), seed(seedValue), movesPlayed(0), rave(true), pool(threads),
+          searchBoard(b) {
+        const int numCells = board.getSize() * board.getSize();
+        for (int i = 0; i < pool.size(); i++) {
+            workerBoards.push_back(board);
+            workerEngines.emplace_back(mixSeed(seed, i));
+            workerAmafWins.emplace_back(numCells, 0);
+            workerAmafVisits.emplace_back(numCells, 0);
+        }
+        cells.reserve(numCells);
+        candidates.reserve(numCells);
+        wins.reserve(numCells);
+        playouts.reserve(numCells);
+        roundWins.reserve(numCells);
+        roundPlayouts.reserve(numCells);
+    }
+    
+    // Enable or disable RAVE (on by default)
+    void setRave(bool enabled) {
+        rave = enabled;
+    }
+    
+    // Enable or disable bridge responses in playouts (on by default)
+    void setBridgeResponses(bool enabled) {
+        for (PlayoutEngine& engine : workerEngines) {
+            engine.setBridgeResponses(enabled);
+        }
+    }
+    
+    // Number of playouts run by each call to runSimulations
+    int getSimulations() const {
+        return SIMULATIONS;
+    }
+    
+    std::pair<int, int> getMove() override {
+        int size = board.getSize();
+        std::pair<int, int> bestMove = {-1, -1};
+        startSearch();
+        searchBoard = board;
+        if (capturedFill) fillCapturedCells(searchBoard);
+        
+        // Collect every legal move that is not dead or captured
+        getLiveCells(searchBoard, cells);
+        candidates.clear();
+        for (int cell : cells) {
+            candidates.push_back({cell / size, cell % size});
+        }
+        if (candidates.empty()) {
+            return bestMove;
+        }
+        const int numCandidates = static_cast<int>(candidates.size());
+        
+        // Playouts per candidate: from the playout budget, unbounded under a
+        // time-only budget, or the fixed default
+        long long perCandidate = SIMULATIONS;
+        if (budget.playouts > 0) {
+            perCandidate = std::max(1LL, budget.playouts / numCandidates);
+        } else if (budget.timeMs > 0) {
+            perCandidate = -1;
+        }
+        
+        // Each worker starts from its own copy of the current position
+        for (Board& workerBoard : workerBoards) {
+            workerBoard = searchBoard;
+        }
+        for (int w = 0; w < pool.size(); w++) {
+            std::fill(workerAmafWins[w].begin(), workerAmafWins[w].end(), 0);
+            std::fill(workerAmafVisits[w].begin(), workerAmafVisits[w].end(), 0);
+        }
+        
+        const uint64_t moveSeed = mixSeed(seed, movesPlayed++);
+        wins.assign(numCandidates, 0);
+        playouts.assign(numCandidates, 0);
+        roundWins.assign(numCandidates, 0);
+        roundPlayouts.assign(numCandidates, 0);
+        long long done = 0;
+        
+        for (int round = 0; perCandidate < 0 || done < perCandidate; round++) {
+            int batch = BATCH_SIZE;
+            if (perCandidate > 0) {
+                batch = static_cast<int>(std::min<long long>(batch, perCandidate - done));
+            }
+            
+            pool.run(numCandidates, [&](int task, int worker) {
+                // After the first round, tasks that start past the deadline are skipped
+                roundWins[task] = 0;
+                roundPlayouts[task] = 0;
+                if (round > 0 && outOfTime()) return;
+                
+                auto [x, y] = candidates[task];
+                Board& local = workerBoards[worker];
+                PlayoutEngine& engine = workerEngines[worker];
+                
+                // Make temporary move, simulate, undo
+                local.makeMove(x, y, playerType);
+                engine.seed(mixSeed(moveSeed, static_cast<uint64_t>(round) * numCandidates + task));
+                if (rave) {
+                    roundWins[task] = engine.runPlayouts(local, -playerType, batch, playerType,
+                                                         workerAmafWins[worker].data(),
+                                                         workerAmafVisits[worker].data());
+                } else {
+                    roundWins[task] = engine.runPlayouts(local, -playerType, batch, playerType);
+                }
+                roundPlayouts[task] = batch;
+                local.makeMove(x, y, 0);
+            });
+            
+            for (int m = 0; m < numCandidates; m++) {
+                wins[m] += roundWins[m];
+                playouts[m] += roundPlayouts[m];
+                stats.playouts += roundPlayouts[m];
+            }
+            done += batch;
+            if (outOfTime()) break;
+        }
+        
+        // Highest score wins; candidates are scanned in order so ties break
+        // the same way every run
+        int best = -1;
+        double bestScore = -1.0;
+        for (int m = 0; m < numCandidates; m++) {
+            double score = static_cast<double>(wins[m]) / playouts[m];
+            if (rave) {
+                int cell = candidates[m].first * size + candidates[m].second;
+                long long amafWins = 0;
+                long long amafVisits = 0;
+                for (int w = 0; w < pool.size(); w++) {
+                    amafWins += workerAmafWins[w][cell];
+                    amafVisits += workerAmafVisits[w][cell];
+                }
+                if (amafVisits > 0) {
+                    double beta = std::sqrt(RAVE_EQUIVALENCE / (3.0 * playouts[m] + RAVE_EQUIVALENCE));
+                    score = (1.0 - beta) * score + beta * static_cast<double>(amafWins) / amafVisits;
+                }
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                best = m;
+            }
+        }
+        bestMove = candidates[best];
+        
+        finishSearch();
+        return bestMove;
+    }
+    
+    // Run simulations and return the number of wins
+    int runSimulations() {
+        // The candidate move has been made, so the opponent moves first
+        return workerEngines[0].runPlayouts(board, -playerType, SIMULATIONS, playerType);
+    }
+};
+
+// Monte Carlo Tree Search player (UCT)
+// Grows a search tree one node per iteration: descend by UCT, expand a leaf
+// that has been visited before, run one fill-then-evaluate playout, and back
+// the result up the path. Nodes live in an index-based arena. After each move
+// the subtree under our move and the opponent's reply becomes the new root,
+// so statistics gathered in earlier searches are kept.
+// With RAVE enabled each child also keeps All-Moves-As-First statistics,
+// updated from every playout below its parent in which the child's player
+// filled the child's cell, and UCT uses a blend of both win rates.
+// Optionally (setTranspositions), node statistics are also kept in a
+// transposition table keyed by the position's hash, and a node visited for
+// the first time starts from the table's entry, capped at its parent's
+// visits. It is off by default: hits are rare (well under 1% of iterations)
+// and measured no gain in strength, while every backed-up node pays for a
+// store.
+class MctsPlayer : public SearchPlayer {
+private:
+    struct Node {
+        int firstChild;     // Arena index of the first child, -1 if not expanded, NO_ROOM if it never will be
+        int numChildren;    // Children are stored contiguously
+        int visits;
+        int wins;           // Playouts won by the player who made 'move'
+        int amafVisits;     // Playouts below the parent where 'player' filled 'move'
+        int amafWins;       // ... and 'player' won
+        int16_t move;       // Cell index played to reach this node
+        int8_t player;      // Player who made 'move'
+    };
+    
+    Board& board;
+    int playerType;
+    const int ITERATIONS = 10000;       // Default playouts per move
+    const double EXPLORATION = 0.5;     // UCT exploration constant
+    const int TABLE_BITS = 16;          // Transposition table of 2^16 slots (1 MB)
+    const long long MAX_TREE_NODES = 1 << 20;   // Node arena capacity (28 MB); a full arena stops expanding
+    const int EXPANSION_RATIO = 16;     // A leaf is expanded once visits * ratio reach its empty cells
+    static const int NO_ROOM = -2;      // firstChild of a leaf whose children did not fit
+    const double RAVE_EQUIVALENCE = 1000.0;     // Visits at which direct and AMAF weigh equally (roughly)
+    bool rave;                          // Blend in AMAF statistics
+    std::vector<Node> nodes;            // Node arena; index 0 is the root
+    std::vector<Node> spare;            // Second arena used when re-rooting
+    Board searchBoard;                  // Position being searched, moves made/undone in place
+    Board lastRoot;                     // Position at the previous search
+    int lastMove;                       // Cell we chose at the previous search, -1 if none
+    uint64_t lastFill;                  // Hash of the captured cells filled at the previous search
+    std::vector<int> path;              // Node indices visited by the current iteration
+    std::vector<uint64_t> pathHashes;   // Position hash at each node of 'path'
+    std::vector<int> emptyCells;        // Scratch for expansion
+    PlayoutEngine engine;
+    std::unique_ptr<TranspositionTable> table;  // Visits and wins per position hash; null when off
+    
+public:
+    MctsPlayer(Board& b, int type, unsigned int seed = static_cast<unsigned int>(std::time(nullptr)))
+        : board(b), playerType(type), rave(true), searchBoard(b), lastRoot(b), lastMove(-1), lastFill(0), engine(seed) {
+        // A path or an expansion never holds more than every cell plus the root
+        const int numCells = board.getSize() * board.getSize();
+        path.reserve(numCells + 1);
+        pathHashes.reserve(numCells + 1);
+        emptyCells.reserve(numCells);
+    }
+    
+    // Enable or disable RAVE (on by default)
+    void setRave(bool enabled) {
+        rave = enabled;
+    }
+    
+    // Enable or disable the transposition table (off by default)
+    void setTranspositions(bool enabled) {
+        if (!enabled) {
+            table.reset();
+        } else if (!table) {
+            table = std::make_unique<TranspositionTable>(TABLE_BITS);
+        }
+    }
+    
+    // Enable or disable bridge responses in playouts (on by default)
+    void setBridgeResponses(bool enabled) {
+        engine.setBridgeResponses(enabled);
+    }
+    
+    std::pair<int, int> getMove() override {
+        const int size = board.getSize();
+        startSearch();
+        searchBoard = board;
+        if (capturedFill) fillCapturedCells(searchBoard);
+        reuseOrResetTree(searchBoard.getHash() ^ board.getHash());
+        
+        // Anytime search: iterate until the budget runs out, but always long
+        // enough for the root to have children to choose from
+        long long limit = ITERATIONS;
+        if (budget.playouts > 0) {
+            limit = budget.playouts;
+        } else if (budget.timeMs > 0) {
+            limit = -1;
+        }
+        
+        // Size the arena before searching: apart from the root's children,
+        // the tree grows by at most EXPANSION_RATIO nodes per iteration (see
+        // runIteration), and never past the capacity reserved here. Twice
+        // that leaves room for a reused subtree, which a previous search of
+        // the same budget grew; the size only falls as the board fills, so
+        // both arenas are reserved once per game, before the first re-rooting
+        // needs the spare one.
+        const long long numEmpty = searchBoard.getEmptyCount();
+        long long capacity = MAX_TREE_NODES;
+        if (limit >= 0) {
+            capacity = std::min(capacity, 2 * ((limit + 1) * EXPANSION_RATIO + numEmpty + 1));
+        }
+        nodes.reserve(static_cast<size_t>(capacity));
+        spare.reserve(static_cast<size_t>(capacity));
+        while (true) {
+            bool rootExpanded = nodes[0].firstChild >= 0;
+            if (rootExpanded && limit >= 0 && stats.playouts >= limit) break;
+            if (rootExpanded && (stats.playouts & 15) == 0 && outOfTime()) break;
+            runIteration();
+            stats.playouts++;
+        }
+        
+        // Play the most visited move
+        const Node& root = nodes[0];
+        int best = -1;
+        for (int c = root.firstChild; c < root.firstChild + root.numChildren; c++) {
+            if (best < 0 || nodes[c].visits > nodes[best].visits) {
+                best = c;
+            }
+        }
+        finishSearch();
+        if (best < 0) {
+            return {-1, -1};
+        }
+        
+        lastRoot = board;
+        lastMove = nodes[best].move;
+        lastFill = searchBoard.getHash() ^ board.getHash();
+        return {lastMove / size, lastMove % size};
+    }
+    
+    // Number of nodes currently in the tree
+    int getTreeSize() const {
+        return static_cast<int>(nodes.size());
+    }
+    
+private:
+    // Keep the subtree for the current position if the board is exactly the
+    // previous root plus our move and one opponent reply, and the same captured
+    // cells are filled ('fill' hashes them); otherwise start over
+    void reuseOrResetTree(uint64_t fill) {
+        int reply = findOpponentReply();
+        int newRoot = -1;
+        if (reply >= 0 && !nodes.empty() && fill == lastFill) {
+            int ours = findChild(0, lastMove);
+            if (ours >= 0) {
+                newRoot = findChild(ours, reply);
+            }
+        }
+        
+        if (newRoot < 0) {
+            nodes.clear();
+            nodes.push_back({-1, 0, 0, 0, 0, 0, -1, static_cast<int8_t>(-playerType)});
+            return;
+        }
+        
+        // Copy the subtree into the spare arena, breadth first, so the arena
+        // only ever holds reachable nodes. The two arenas swap roles every
+        // move and keep their storage, so once both have grown to the size of
+        // a search the tree never reallocates.
+        // Until a copied node is reached by the scan, its firstChild holds its
+        // index in the old arena, so the copy needs no separate queue.
+        spare.clear();
+        spare.reserve(nodes.capacity());
+        spare.push_back(nodes[newRoot]);
+        spare[0].firstChild = newRoot;
+        for (size_t q = 0; q < spare.size(); q++) {
+            const Node& old = nodes[spare[q].firstChild];
+            if (old.firstChild < 0) {
+                spare[q].firstChild = -1;
+                continue;
+            }
+            spare[q].firstChild = static_cast<int>(spare.size());
+            for (int c = old.firstChild; c < old.firstChild + old.numChildren; c++) {
+                spare.push_back(nodes[c]);
+                spare.back().firstChild = c;
+            }
+        }
+        nodes.swap(spare);
+    }
+    
+    // The cell the opponent played since our last move, or -1 if the board
+    // is not the previous root plus exactly those two stones
+    int findOpponentReply() const {
+        if (lastMove < 0 || lastRoot.getSize() != board.getSize()) {
+            return -1;
+        }
+        const int size = board.getSize();
+        int reply = -1;
+        int added = 0;
+        for (int x = 0; x < size; x++) {
+            for (int y = 0; y < size; y++) {
+                int before = lastRoot.getValue(x, y);
+                int now = board.getValue(x, y);
+                if (before == now) continue;
+                if (before != 0) return -1;
+                added++;
+                int cell = x * size + y;
+                if (cell == lastMove) {
+                    if (now != playerType) return -1;
+                } else if (now == -playerType) {
+                    reply = cell;
+                } else {
+                    return -1;
+                }
+            }
+        }
+        return added == 2 ? reply : -1;
+    }
+    
+    int findChild(int parent, int move) const {
+        const Node& node = nodes[parent];
+        for (int c = node.firstChild; c < node.firstChild + node.numChildren; c++) {
+            if (nodes[c].move == move) return c;
+        }
+        return -1;
+    }
+    
+    void runIteration() {
+        const int size = searchBoard.getSize();
+        int current = 0;
+        int winner = 0;
+        path.clear();
+        path.push_back(current);
+        pathHashes.clear();
+        pathHashes.push_back(searchBoard.getHash());
+        
+        // Selection: follow UCT until reaching a leaf or a finished game
+        while (nodes[current].firstChild >= 0) {
+            current = selectChild(current);
+            enterChild(current);
+            const Node& node = nodes[current];
+            if (searchBoard.hasWon(node.player)) {
+                winner = node.player;
+                break;
+            }
+        }
+        
+        // Expansion: the root as soon as it has been seen, any other leaf once
+        // it has had a visit per EXPANSION_RATIO empty cells. A leaf's visits
+        // pay for its children, so the tree grows by at most EXPANSION_RATIO
+        // nodes per iteration however large the board.
+        if (winner == 0 && nodes[current].firstChild == -1 && nodes[current].visits > 0
+            && (current == 0
+                || static_cast<long long>(nodes[current].visits) * EXPANSION_RATIO >= searchBoard.getEmptyCount())) {
+            expand(current);
+            if (nodes[current].numChildren > 0) {
+                current = nodes[current].firstChild;
+                enterChild(current);
+                const Node& node = nodes[current];
+                if (searchBoard.hasWon(node.player)) {
+                    winner = node.player;
+                }
+            }
+        }
+        
+        // Simulation
+        bool simulated = false;
+        if (winner == 0) {
+            winner = engine.playout(searchBoard, -nodes[current].player);
+            simulated = true;
+        }
+        
+        // AMAF update: every cell is filled at the end of a playout, so a child
+        // of a path node counts if its player owns its cell on the final board
+        if (rave && simulated) {
+            const uint64_t* filledWhite = engine.getFilledWhite();
+            for (int index : path) {
+                const Node& parent = nodes[index];
+                for (int c = parent.firstChild; c < parent.firstChild + parent.numChildren; c++) {
+                    Node& child = nodes[c];
+                    int owner = testBit(filledWhite, child.move) ? 1 : -1;
+                    if (owner == child.player) {
+                        child.amafVisits++;
+                        if (winner == child.player) child.amafWins++;
+                    }
+                }
+            }
+        }
+        
+        // Backpropagation, undoing the moves on the way back up
+        for (int i = static_cast<int>(path.size()) - 1; i >= 0; i--) {
+            Node& node = nodes[path[i]];
+            node.visits++;
+            if (node.player == winner) node.wins++;
+            if (table) {
+                table->store(pathHashes[i], (static_cast<uint64_t>(node.visits) << 32) | static_cast<uint32_t>(node.wins));
+            }
+            if (i > 0) {
+                searchBoard.makeMove(node.move / size, node.move % size, 0);
+            }
+        }
+    }
+    
+    // Play the move of 'child' on the search board and add it to the path. A
+    // node entered for the first time takes its statistics from the
+    // transposition table if this position has been searched before, scaled
+    // down to at most its parent's visits so it never looks better explored
+    // than the parent.
+    void enterChild(int child) {
+        const int size = searchBoard.getSize();
+        Node& node = nodes[child];
+        searchBoard.makeMove(node.move / size, node.move % size, node.player);
+        path.push_back(child);
+        pathHashes.push_back(searchBoard.getHash());
+        
+        uint64_t entry;
+        if (table && node.visits == 0 && table->probe(searchBoard.getHash(), entry)) {
+            long long visits = static_cast<long long>(entry >> 32);
+            long long wins = static_cast<long long>(entry & 0xFFFFFFFFULL);
+            long long cap = nodes[path[path.size() - 2]].visits;
+            if (visits > cap) {
+                wins = visits > 0 ? wins * cap / visits : 0;
+                visits = cap;
+            }
+            node.visits = static_cast<int>(visits);
+            node.wins = static_cast<int>(wins);
+            stats.tableHits++;
+        }
+    }
+    
+    int selectChild(int parent) const {
+        const Node& node = nodes[parent];
+        const double logVisits = std::log(static_cast<double>(node.visits));
+        int best = node.firstChild;
+        double bestValue = -1.0;
+        for (int c = node.firstChild; c < node.firstChild + node.numChildren; c++) {
+            const Node& child = nodes[c];
+            double value;
+            if (rave && child.amafVisits > 0) {
+                // Unvisited children are ranked by AMAF alone, as if visited once
+                double amafRate = static_cast<double>(child.amafWins) / child.amafVisits;
+                if (child.visits == 0) {
+                    value = amafRate + EXPLORATION * std::sqrt(logVisits);
+                } else {
+                    double beta = std::sqrt(RAVE_EQUIVALENCE / (3.0 * child.visits + RAVE_EQUIVALENCE));
+                    double winRate = static_cast<double>(child.wins) / child.visits;
+                    value = (1.0 - beta) * winRate + beta * amafRate
+                          + EXPLORATION * std::sqrt(logVisits / child.visits);
+                }
+            } else {
+                if (child.visits == 0) return c;
+                value = static_cast<double>(child.wins) / child.visits
+                      + EXPLORATION * std::sqrt(logVisits / child.visits);
+            }
+            if (value > bestValue) {
+                bestValue = value;
+                best = c;
+            }
+        }
+        return best;
+    }
+    
+    // Give 'parent' its children, unless they would not fit in the arena; the
+    // node then stays a leaf for the rest of the search, evaluated by
+    // playouts only, and is not scanned again
+    void expand(int parent) {
+        NASH_PHASE(PHASE_EXPANSION);
+        getLiveCells(searchBoard, emptyCells);
+        if (nodes.size() + emptyCells.size() > nodes.capacity()) {
+            nodes[parent].firstChild = NO_ROOM;
+            return;
+        }
+        int8_t mover = static_cast<int8_t>(-nodes[parent].player);
+        int first = static_cast<int>(nodes.size());
+        for (int cell : emptyCells) {
+            nodes.push_back({-1, 0, 0, 0, 0, 0, static_cast<int16_t>(cell), mover});
+        }
+        nodes[parent].firstChild = first;
+        nodes[parent].numChildren = static_cast<int>(emptyCells.size());
+    }
+};
+
+// Alpha-beta search player
+// Negamax with alpha-beta pruning and iterative deepening: depth 1, 2, ...
+// until the node or time budget runs out, playing the best move of the
+// deepest completed iteration. Moves are tried in the order: best move from
+// the transposition table, the two killer moves of the ply, then by history
+// score. Leaves are scored by a pluggable evaluator from the point of view of
+// the player to move; the default is the shortest-path evaluator.
+class AlphaBetaPlayer : public SearchPlayer {
+public:
+    // Score of 'board' for 'playerType' (higher is better)
+    using Evaluator = std::function<int(const Board&, int)>;
+    
+private:
+    // Transposition table entry, packed into one 64-bit payload
+    enum Bound { EXACT = 1, LOWER = 2, UPPER = 3 };
+    
+    Board& board;
+    int playerType;
+    Evaluator evaluate;
+    bool ordering;                      // Killer/history/table move ordering
+    const long long NODES = 100000;     // Default nodes per move
+    const int MAX_DEPTH = 64;
+    const int WIN_SCORE = 1000000;      // Win at the root; a win at ply p scores WIN_SCORE - p
+    const int TABLE_BITS = 18;          // Transposition table of 2^18 slots (4 MB)
+    const int EVAL_TABLE_BITS = 16;     // Leaf evaluation cache of 2^16 slots (1 MB)
+    const uint64_t BLACK_TO_MOVE = 0x9E3779B97F4A7C15ULL;  // Evaluation cache key salt
+    Board searchBoard;
+    TranspositionTable table;
+    TranspositionTable evalTable;       // Leaf scores per position and player to move
+    bool evalCache;                     // Use evalTable
+    std::vector<std::vector<int>> moveLists;    // Moves per ply, reused
+    std::vector<std::vector<int64_t>> moveKeys;  // Scratch for move ordering
+    std::vector<int> killers;           // Two per ply
+    std::vector<int> history;           // Per player (White first) and cell
+    long long nodeLimit;
+    bool aborted;
+    int rootBest;                       // Best root move of the current iteration
+    
+public:
+    AlphaBetaPlayer(Board& b, int type)
+        : board(b), playerType(type), ordering(true), searchBoard(b), table(TABLE_BITS),
+          evalTable(EVAL_TABLE_BITS), evalCache(true), moveLists(MAX_DEPTH + 1), moveKeys(MAX_DEPTH + 1),
+          killers(2 * (MAX_DEPTH + 1), -1), history(2 * MAX_CELLS, 0),
+          nodeLimit(0), aborted(false), rootBest(-1) {
+        // Give every ply room for all the cells, so searching deeper never allocates
+        const int numCells = board.getSize() * board.getSize();
+        for (int ply = 0; ply <= MAX_DEPTH; ply++) {
+            moveLists[ply].reserve(numCells);
+            moveKeys[ply].reserve(numCells);
+        }
+        evaluate = [](const Board& position, int player) {
+            return position.evaluateConnection(player);
+        };
+    }
+    
+    void setEvaluator(const Evaluator& evaluator) {
+        evaluate = evaluator;
+        evalTable.clear();
+    }
+    
+    // Enable or disable the leaf evaluation cache (on by default)
+    void setEvaluationCache(bool enabled) {
+        evalCache = enabled;
+    }
+    
+    // Enable or disable move ordering (on by default), to measure its effect
+    void setMoveOrdering(bool enabled) {
+        ordering = enabled;
+    }
+    
+    std::pair<int, int> getMove() override {
+        const int size = board.getSize();
+        startSearch();
+        searchBoard = board;
+        if (capturedFill) fillCapturedCells(searchBoard);
+        nodeLimit = budget.playouts > 0 ? budget.playouts : (budget.timeMs > 0 ? -1 : NODES);
+        aborted = false;
+        std::fill(killers.begin(), killers.end(), -1);
+        for (int& score : history) score /= 8;  // Keep some history from the previous move
+        
+        // Iterative deepening; depth 1 always completes so there is a move to play
+        int best = -1;
+        long long previousNodes = 0;
+        const int numEmpty = size * size - searchBoard.getStoneCount();
+        for (int depth = 1; depth <= std::min(MAX_DEPTH, numEmpty); depth++) {
+            long long before = stats.playouts;
+            rootBest = -1;
+            int score = negamax(depth, -WIN_SCORE - 1, WIN_SCORE + 1, 0, playerType, -1);
+            if (aborted) break;
+            
+            best = rootBest;
+            long long nodes = stats.playouts - before;
+            stats.depth = depth;
+            stats.branchingFactor = previousNodes > 0 ? static_cast<double>(nodes) / previousNodes : nodes;
+            previousNodes = nodes;
+            
+            // A proven result will not change with more depth
+            if (std::abs(score) > WIN_SCORE - 1000 || budgetUsed()) break;
+        }
+        
+        finishSearch();
+        if (best < 0) {
+            return {-1, -1};
+        }
+        return {best / size, best % size};
+    }
+    
+private:
+    bool budgetUsed() const {
+        return (nodeLimit >= 0 && stats.playouts >= nodeLimit) || outOfTime();
+    }
+    
+    // 'lastMove' is the cell the opponent just played, or -1 at the root
+    // Once depth 1 has finished, a node past the node budget aborts before it
+    // is counted, so a search never exceeds the budget; the clock is only
+    // read every 256 nodes.
+    int negamax(int depth, int alpha, int beta, int ply, int toMove, int lastMove) {
+        if (ply > 0 && stats.depth > 0
+            && ((nodeLimit >= 0 && stats.playouts >= nodeLimit) || ((stats.playouts & 255) == 0 && outOfTime()))) {
+            aborted = true;
+        }
+        if (aborted) return 0;
+        stats.playouts++;
+        
+        // Transposition table: use a deep enough result, or at least its move
+        const uint64_t key = searchBoard.getHash();
+        const int originalAlpha = alpha;
+        int tableMove = -1;
+        uint64_t entry;
+        if (table.probe(key, entry)) {
+            stats.tableHits++;
+            int score = toScore(entry, ply);
+            int entryDepth = static_cast<int>((entry >> 48) & 0xFF);
+            int bound = static_cast<int>(entry >> 56);
+            tableMove = static_cast<int>((entry >> 32) & 0xFFFF) - 1;
+            if (ply > 0 && entryDepth >= depth) {
+                if (bound == EXACT) return score;
+                if (bound == LOWER && score >= beta) return score;
+                if (bound == UPPER && score <= alpha) return score;
+            }
+        }
+        
+        if (depth == 0) {
+            return evaluateLeaf(key, toMove);
+        }
+        
+        std::vector<int>& moves = moveLists[ply];
+        {
+            NASH_PHASE(PHASE_EXPANSION);
+            getLiveCells(searchBoard, moves);
+            if (ordering) {
+                orderMoves(moves, ply, toMove, tableMove, lastMove);
+            }
+        }
+        
+        const int size = searchBoard.getSize();
+        int bestScore = -WIN_SCORE - 1;
+        int bestMove = -1;
+        for (int move : moves) {
+            searchBoard.makeMove(move / size, move % size, toMove);
+            int score;
+            if (searchBoard.hasWon(toMove)) {
+                score = WIN_SCORE - ply - 1;
+            } else {
+                score = -negamax(depth - 1, -beta, -alpha, ply + 1, -toMove, move);
+            }
+            searchBoard.makeMove(move / size, move % size, 0);
+            if (aborted) return 0;
+            
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = move;
+                if (ply == 0) rootBest = move;
+            }
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) {
+                // Cutoff: remember the move for siblings and later searches
+                if (killers[2 * ply] != move) {
+                    killers[2 * ply + 1] = killers[2 * ply];
+                    killers[2 * ply] = move;
+                }
+                history[(toMove == 1 ? 0 : MAX_CELLS) + move] += depth * depth;
+                break;
+            }
+        }
+        
+        Bound bound = bestScore <= originalAlpha ? UPPER : (bestScore >= beta ? LOWER : EXACT);
+        table.store(key, pack(bestScore, bestMove, depth, bound, ply));
+        return bestScore;
+    }
+    
+    // Score a leaf for 'toMove'. Hex has no captures, so the same leaf is
+    // reached through every order of the same moves; its score is cached
+    // separately from the search results so leaves never evict deeper entries.
+    int evaluateLeaf(uint64_t key, int toMove) {
+        const uint64_t evalKey = toMove == 1 ? key : key ^ BLACK_TO_MOVE;
+        uint64_t entry;
+        if (evalCache && evalTable.probe(evalKey, entry)) {
+            stats.tableHits++;
+            return static_cast<int32_t>(entry & 0xFFFFFFFFULL);
+        }
+        NASH_PHASE(PHASE_EVALUATION);
+        int score = evaluate(searchBoard, toMove);
+        if (evalCache) {
+            // Bit 32 keeps the payload nonzero
+            evalTable.store(evalKey, (1ULL << 32) | static_cast<uint32_t>(score));
+        }
+        return score;
+    }
+    
+    // Sort 'moves' best first: table move, the reply that saves a bridge the
+    // opponent's last move broke into, killers, then history score. Each move
+    // is packed with its score into one key so a plain sort orders them, with
+    // ties broken by cell index.
+    void orderMoves(std::vector<int>& moves, int ply, int toMove, int tableMove, int lastMove) {
+        std::vector<int64_t>& keys = moveKeys[ply];
+        keys.resize(moves.size());
+        const int* playerHistory = history.data() + (toMove == 1 ? 0 : MAX_CELLS);
+        const int bridgeSave = lastMove >= 0 ? findBridgeSave(searchBoard, lastMove, toMove) : -1;
+        for (size_t i = 0; i < moves.size(); i++) {
+            int move = moves[i];
+            int64_t score = playerHistory[move];
+            if (move == tableMove) score = INT32_MAX;
+            else if (move == bridgeSave) score = INT32_MAX - 1;
+            else if (move == killers[2 * ply]) score = INT32_MAX - 2;
+            else if (move == killers[2 * ply + 1]) score = INT32_MAX - 3;
+            keys[i] = (score << 16) | (0xFFFF - move);
+        }
+        std::sort(keys.begin(), keys.end(), std::greater<int64_t>());
+        for (size_t i = 0; i < moves.size(); i++) {
+            moves[i] = 0xFFFF - static_cast<int>(keys[i] & 0xFFFF);
+        }
+    }
+    
+    // Win scores are stored relative to the node so they stay valid at any ply
+    uint64_t pack(int score, int move, int depth, Bound bound, int ply) const {
+        if (score > WIN_SCORE - 1000) score += ply;
+        else if (score < -WIN_SCORE + 1000) score -= ply;
+        return static_cast<uint32_t>(score)
+             | (static_cast<uint64_t>(move + 1) << 32)
+             | (static_cast<uint64_t>(depth) << 48)
+             | (static_cast<uint64_t>(bound) << 56);
+    }
+    
+    int toScore(uint64_t entry, int ply) const {
+        int score = static_cast<int32_t>(static_cast<uint32_t>(entry));
+        if (score > WIN_SCORE - 1000) score -= ply;
+        else if (score < -WIN_SCORE + 1000) score += ply;
+        return score;
+    }
+};
+
+// Opening book
+// The first moves of a game cost the most search time and come out the same
+// every game, so they are searched once, offline, and stored in a file. The
+// file is an open-addressing hash table indexed by Zobrist hash: a header
+// followed by 2^slotBits entries, probed linearly from hash & (slots - 1).
+// Players map the file into memory instead of reading it, so opening a book
+// costs nothing up front and a lookup touches one or two entries.
+//
+// A position and its 180-degree rotation (cell c <-> n*n - 1 - c) are
+// equivalent in Hex, since the rotation swaps each player's two edges. Only
+// the one with the smaller hash is stored, and the move is rotated back on
+// lookup. Integers are stored in the byte order of the machine that wrote
+// the file.
+
+const char BOOK_MAGIC[8] = {'H', 'E', 'X', 'B', 'O', 'O', 'K', '1'};
+
+struct BookHeader {
+    char magic[8];
+    uint64_t zobristCheck;      // First Zobrist key; books built with other keys are rejected
+    uint32_t slotBits;          // The table has 2^slotBits entries
+    uint32_t entries;           // Entries in use
+};
+
+struct BookEntry {
+    uint64_t key;               // Hash of the stored orientation
+    uint16_t size;              // Board size; 0 marks an empty slot
+    uint16_t move;              // Cell to play in the stored orientation
+    uint32_t playouts;          // Search work that chose the move
+};
+
+// Hash of the position rotated by 180 degrees
+inline uint64_t rotatedHash(const Board& board) {
+    const ZobristKeys& keys = ZobristKeys::instance();
+    const BoardGeometry& geometry = board.getGeometry();
+    int last = geometry.numCells - 1;
+    uint64_t hash = 0;
+    for (int player = 1; player >= -1; player -= 2) {
+        const uint64_t* stones = board.getStones(player);
+        for (int w = 0; w < geometry.numWords; w++) {
+            for (uint64_t bits = stones[w]; bits; bits &= bits - 1) {
+                hash ^= keys.key(last - (w * 64 + __builtin_ctzll(bits)), player);
+            }
+        }
+    }
+    return hash;
+}
+
+// Write 'moves' (stored-orientation hash -> entry) as a book file with a
+// table at most half full
+bool writeOpeningBook(const std::string& path, const std::map<std::pair<int, uint64_t>, BookEntry>& moves) {
+    uint32_t slotBits = 4;
+    while ((1ULL << slotBits) < 2 * moves.size()) slotBits++;
+    uint64_t mask = (1ULL << slotBits) - 1;
+    std::vector<BookEntry> table(mask + 1, BookEntry{0, 0, 0, 0});
+    for (const auto& item : moves) {
+        uint64_t slot = item.second.key & mask;
+        while (table[slot].size != 0) slot = (slot + 1) & mask;
+        table[slot] = item.second;
+    }
+    
+    BookHeader header;
+    std::copy(BOOK_MAGIC, BOOK_MAGIC + sizeof(BOOK_MAGIC), header.magic);
+    header.zobristCheck = ZobristKeys::instance().key(0, 1);
+    header.slotBits = slotBits;
+    header.entries = static_cast<uint32_t>(moves.size());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(BookEntry)));
+    return static_cast<bool>(file);
+}
+
+// Read-only view of a book file, mapped into memory. Lookups are const and
+// safe from any number of threads.
+class OpeningBook {
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    const BookEntry* table = nullptr;
+    uint64_t mask = 0;
+    uint32_t entries = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    
+    void unmap() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#else
+        if (data) munmap(const_cast<char*>(data), length);
+#endif
+        data = nullptr;
+        table = nullptr;
+        length = 0;
+        entries = 0;
+    }
+    
+    // Map the whole file read-only; false if it is missing or empty
+    bool map(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER fileSize;
+        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        length = static_cast<size_t>(fileSize.QuadPart);
+        return data != nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);  // The mapping stays valid without the descriptor
+        if (view == MAP_FAILED) return false;
+        data = static_cast<const char*>(view);
+        length = static_cast<size_t>(info.st_size);
+        return true;
+#endif
+    }
+    
+public:
+    OpeningBook() {}
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+    
+    ~OpeningBook() {
+        unmap();
+    }
+    
+    // Map 'path' and check its header; false (and an empty book) if it is
+    // not a book file written with this program's Zobrist keys
+    bool open(const std::string& path) {
+        unmap();
+        if (!map(path)) {
+            unmap();
+            return false;
+        }
+        BookHeader header;
+        if (length < sizeof(header)) {
+            unmap();
+            return false;
+        }
+        std::copy(data, data + sizeof(header), reinterpret_cast<char*>(&header));
+        if (!std::equal(BOOK_MAGIC, BOOK_MAGIC + sizeof(BOOK_MAGIC), header.magic)
+            || header.zobristCheck != ZobristKeys::instance().key(0, 1) || header.slotBits > 32
+            || length != sizeof(header) + (1ULL << header.slotBits) * sizeof(BookEntry)) {
+            unmap();
+            return false;
+        }
+        table = reinterpret_cast<const BookEntry*>(data + sizeof(header));
+        mask = (1ULL << header.slotBits) - 1;
+        entries = header.entries;
+        return true;
+    }
+    
+    bool isOpen() const {
+        return table != nullptr;
+    }
+    
+    // Number of positions in the book
+    size_t size() const {
+        return entries;
+    }
+    
+    // Book move (cell index) for the position on 'board', or -1 if there is none
+    int lookup(const Board& board) const {
+        if (!table) return -1;
+        uint64_t hash = board.getHash();
+        uint64_t rotated = rotatedHash(board);
+        uint64_t key = std::min(hash, rotated);
+        for (uint64_t slot = key & mask; table[slot].size != 0; slot = (slot + 1) & mask) {
+            const BookEntry& entry = table[slot];
+            if (entry.key == key && entry.size == board.getSize()) {
+                int cell = hash <= rotated ? entry.move : board.getGeometry().numCells - 1 - entry.move;
+                int size = board.getSize();
+                return board.isValidMove(cell / size, cell % size) ? cell : -1;
+            }
+        }
+        return -1;
+    }
+};
+
+// Plays from an opening book while the position is in it and leaves every
+// other move to the wrapped player
+class BookPlayer : public Player {
+private:
+    Board& board;
+    std::unique_ptr<Player> player;
+    const OpeningBook& book;
+    SearchStats bookStats;
+    bool fromBook;
+    
+public:
+    BookPlayer(Board& b, Player* wrapped, const OpeningBook& openingBook)
+        : board(b), player(wrapped), book(openingBook), fromBook(false) {
+        bookStats.fromBook = true;
+    }
+    
+    std::pair<int, int> getMove() override {
+        int cell = book.lookup(board);
+        fromBook = cell >= 0;
+        if (fromBook) {
+            return {cell / board.getSize(), cell % board.getSize()};
+        }
+        return player->getMove();
+    }
+    
+    const SearchStats* getSearchStats() const override {
+        return fromBook ? &bookStats : player->getSearchStats();
+    }
+};
+
+// Settings shared by every computer player built by createPlayer
+struct PlayerSettings {
+    int threads = 1;            // Worker threads inside a Monte Carlo player
+    SearchBudget budget;        // Per-move budget for search players
+    unsigned int seed = 0;      // RNG seed for players that use randomness
+    SmartEvaluator smartEvaluator = SmartEvaluator::Positional;
+    const OpeningBook* book = nullptr;  // Book consulted by types 2-5 before searching, if set
+};
+
+// Player types: 0: Human, 1: Random, 2: Smart, 3: Monte Carlo, 4: MCTS, 5: Alpha-beta
+const char* playerTypeName(int type) {
+    switch (type) {
+        case 0: return "Human";
+        case 1: return "Random";
+        case 2: return "Smart";
+        case 3: return "Monte Carlo";
+        case 4: return "MCTS";
+        case 5: return "Alpha-beta";
+        default: return "Unknown";
+    }
+}
+
+// Create a player of the given type bound to 'board'; unknown types give a human player
+Player* createPlayer(int type, Board& board, int playerType, const PlayerSettings& settings) {
+    Player* player;
+    switch (type) {
+        case 1:
+            player = new RandomPlayer(board, playerType, settings.seed);
+            break;
+        case 2:
+            player = new SmartPlayer(board, playerType, settings.smartEvaluator);
+            break;
+        case 3:
+            player = new MonteCarloPlayer(board, playerType, settings.threads, settings.seed);
+            break;
+        case 4:
+            player = new MctsPlayer(board, playerType, settings.seed);
+            break;
+        case 5:
+            player = new AlphaBetaPlayer(board, playerType);
+            break;
+        default:
+            player = new HumanPlayer(board, playerType);
+    }
+    if (SearchPlayer* searcher = dynamic_cast<SearchPlayer*>(player)) {
+        searcher->setBudget(settings.budget);
+    }
+    // Only the players that search use the book; Random stays a uniform baseline
+    if (settings.book && type >= 2 && type <= 5) {
+        player = new BookPlayer(board, player, *settings.book);
+    }
+    return player;
+}
+
+// Game records
+// A finished game is kept as its move list plus the search work behind each
+// move, so statistics can be recomputed later without running the players
+// again. Records are written one after another to an append-only file,
+// either in a compact binary format or as SGF-like text, one game per line.
+//
+// Binary: the file starts with RECORD_MAGIC; each record is a sequence of
+// unsigned LEB128 varints: game, size, white type, black type, seed, winner
+// (1: White, 2: Black), number of moves, then cell, playouts and
+// microseconds for every move.
+//
+// Text: (;FF[4]GM[11]SZ[7]PW[MCTS]PB[Random]RE[W+]GN[0]SE[42];W[d4]XP[10000]XT[3120];B[c5]...)
+// Cells are named by column letters (a, b, ..., z, aa, ...) and row number.
+// XP and XT carry the playouts and microseconds of the move.
+
+const char RECORD_MAGIC[8] = {'H', 'E', 'X', 'R', 'E', 'C', '1', '\n'};
+
+struct RecordedMove {
+    int cell;                   // x * size + y
+    long long playouts = 0;     // Search work for the move (0 for players that do not search)
+    long long micros = 0;       // Time the player took to choose it
+};
+
+struct GameRecord {
+    int game = 0;               // Game number within its match
+    int size = 0;
+    int whiteType = 0;          // Player types as in createPlayer
+    int blackType = 0;
+    unsigned int seed = 0;      // Match seed the game was played with
+    int winner = 0;             // 1: White, -1: Black
+    std::vector<RecordedMove> moves;
+};
+
+// Cell name in the text format, e.g. "c5" for column 2, row 4
+std::string recordCellName(int cell, int size) {
+    std::string letters;
+    for (int column = cell % size + 1; column > 0; column = (column - 1) / 26) {
+        letters.insert(letters.begin(), static_cast<char>('a' + (column - 1) % 26));
+    }
+    return letters + std::to_string(cell / size + 1);
+}
+
+// Inverse of recordCellName; -1 if the name is not a cell of the board
+int parseRecordCellName(const std::string& name, int size) {
+    size_t i = 0;
+    int column = 0;
+    while (i < name.size() && name[i] >= 'a' && name[i] <= 'z' && column <= size) {
+        column = column * 26 + (name[i++] - 'a' + 1);
+    }
+    int row = 0;
+    size_t digits = i;
+    while (i < name.size() && name[i] >= '0' && name[i] <= '9' && row <= size) {
+        row = row * 10 + (name[i++] - '0');
+    }
+    if (i != name.size() || digits == i || column < 1 || column > size || row < 1 || row > size) {
+        return -1;
+    }
+    return (row - 1) * size + column - 1;
+}
+
+// Appends records to a file through an in-memory buffer. Safe to share
+// between the games of a parallel match; records land in the order games
+// finish, and each one carries its game number.
+class GameRecordWriter {
+private:
+    std::ofstream file;
+    bool text;                  // SGF-like text instead of binary
+    std::vector<char> buffer;
+    std::mutex mutex;
+    const size_t FLUSH_SIZE = 1 << 16;
+    
+public:
+    // Open 'path' for appending; names ending in ".sgf" get the text format
+    explicit GameRecordWriter(const std::string& path)
+        : file(path, std::ios::binary | std::ios::app),
+          text(path.size() >= 4 && path.compare(path.size() - 4, 4, ".sgf") == 0) {
+        buffer.reserve(FLUSH_SIZE + 4096);
+        file.seekp(0, std::ios::end);
+        if (file && !text && file.tellp() == 0) {
+            buffer.insert(buffer.end(), RECORD_MAGIC, RECORD_MAGIC + sizeof(RECORD_MAGIC));
         }
-        return true;
     }
     
-    // Task 3: Check if a player has a complete straight line
-    bool hasCompleteLineWin(int playerType) const {
-        // Check rows (for White player)
-        if (playerType == 1) {
-            for (int row = 0; row < size; row++) {
-                bool completeRow = true;
-                for (int col = 0; col < size; col++) {
-                    if (board[row][col] != playerType) {
-                        completeRow = false;
-                        break;
-                    }
-                }
-                if (completeRow) return true;
-            }
+    ~GameRecordWriter() {
+        flush();
+    }
+    
+    bool isOpen() const {
+        return static_cast<bool>(file);
+    }
+    
+    void write(const GameRecord& record) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (text) {
+            appendText(record);
+        } else {
+            appendBinary(record);
         }
-        // Check columns (for Black player)
-        else if (playerType == -1) {
-            for (int col = 0; col < size; col++) {
-                bool completeCol = true;
-                for (int row = 0; row < size; row++) {
-                    if (board[row][col] != playerType) {
-                        completeCol = false;
-                        break;
-                    }
-                }
-                if (completeCol) return true;
-            }
+        if (buffer.size() >= FLUSH_SIZE) {
+            flushLocked();
         }
-        return false;
     }
     
-    // Task 4: Get neighbors of a cell with the same player's stones
-    std::stack<std::pair<int, int>> getNeighbours(int playerType, int x, int y) {
-        std::stack<std::pair<int, int>> neighbors;
-        
-        for (int i = 0; i < 6; i++) {
-            int nx = x + DX[i];
-            int ny = y + DY[i];
-            
-            if (nx >= 0 && nx < size && ny >= 0 && ny < size && board[nx][ny] == playerType) {
-                neighbors.push({nx, ny});
-            }
-        }
-        
-        return neighbors;
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushLocked();
     }
     
-    // Print all neighbors of a cell with the same player's stones
-    void printNeighbours(int x, int y) {
-        int playerType = board[x][y];
-        if (playerType == 0) {
-            std::cout << "Cell (" << x + 1 << "," << y + 1 << ") is empty." << std::endl;
-            return;
+private:
+    void flushLocked() {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.flush();
+        buffer.clear();
+    }
+    
+    void appendVarint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
         }
-        
-        std::stack<std::pair<int, int>> neighbors = getNeighbours(playerType, x, y);
-        std::cout << "Neighbors of (" << x + 1 << "," << y + 1 << ") with " 
-                  << (playerType == 1 ? "White" : "Black") << " stones:" << std::endl;
-        
-        if (neighbors.empty()) {
-            std::cout << "No neighbors with the same stone." << std::endl;
-            return;
+        buffer.push_back(static_cast<char>(value));
+    }
+    
+    void appendBinary(const GameRecord& record) {
+        appendVarint(record.game);
+        appendVarint(record.size);
+        appendVarint(record.whiteType);
+        appendVarint(record.blackType);
+        appendVarint(record.seed);
+        appendVarint(record.winner == 1 ? 1 : 2);
+        appendVarint(record.moves.size());
+        for (const RecordedMove& move : record.moves) {
+            appendVarint(move.cell);
+            appendVarint(move.playouts);
+            appendVarint(move.micros);
         }
-        
-        while (!neighbors.empty()) {
-            std::pair<int, int> pos = neighbors.top();
-            neighbors.pop();
-            std::cout << "(" << pos.first + 1 << "," << pos.second + 1 << ") ";
+    }
+    
+    void appendText(const GameRecord& record) {
+        std::ostringstream line;
+        line << "(;FF[4]GM[11]SZ[" << record.size << "]PW[" << playerTypeName(record.whiteType)
+             << "]PB[" << playerTypeName(record.blackType) << "]RE[" << (record.winner == 1 ? "W+" : "B+")
+             << "]GN[" << record.game << "]SE[" << record.seed << "]";
+        int player = 1;
+        for (const RecordedMove& move : record.moves) {
+            line << ";" << (player == 1 ? "W" : "B") << "[" << recordCellName(move.cell, record.size) << "]";
+            if (move.playouts > 0) line << "XP[" << move.playouts << "]";
+            line << "XT[" << move.micros << "]";
+            player = -player;
         }
-        std::cout << std::endl;
+        line << ")\n";
+        const std::string& data = line.str();
+        buffer.insert(buffer.end(), data.begin(), data.end());
     }
+};
+
+// Reads records back from a file written by GameRecordWriter in either format
+class GameRecordReader {
+private:
+    std::ifstream file;
+    bool text;
     
-    // Task 5: Check if a player has won using DFS
-    bool hasWon(int playerType) {
-        // For White player (1): check path from left to right
-        if (playerType == 1) {
-            // Mark all stones in the leftmost column as starting points
-            std::vector<std::vector<bool>> visited(size, std::vector<bool>(size, false));
-            for (int i = 0; i < size; i++) {
-                if (board[i][0] == playerType) {
-                    // Use DFS to find a path to the rightmost column
-                    if (dfsPathFinding(playerType, i, 0, visited)) {
-                        return true;
-                    }
-                }
-            }
+public:
+    explicit GameRecordReader(const std::string& path) : file(path, std::ios::binary), text(true) {
+        char magic[sizeof(RECORD_MAGIC)];
+        if (file.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), RECORD_MAGIC)) {
+            text = false;
+        } else {
+            file.clear();
+            file.seekg(0);
         }
-        // For Black player (-1): check path from top to bottom
-        else if (playerType == -1) {
-            // Mark all stones in the top row as starting points
-            std::vector<std::vector<bool>> visited(size, std::vector<bool>(size, false));
-            for (int j = 0; j < size; j++) {
-                if (board[0][j] == playerType) {
-                    // Use DFS to find a path to the bottom row
-                    if (dfsPathFinding(playerType, 0, j, visited)) {
-                        return true;
-                    }
-                }
-            }
+    }
+    
+    bool isOpen() const {
+        return file.is_open();
+    }
+    
+    // Read the next record; false at the end of the file or on a damaged record
+    bool next(GameRecord& record) {
+        return text ? nextText(record) : nextBinary(record);
+    }
+    
+private:
+    bool readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = file.get();
+            if (byte == EOF) return false;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
         }
         return false;
     }
     
-    // DFS algorithm to find a winning path
-    bool dfsPathFinding(int playerType, int x, int y, std::vector<std::vector<bool>>& visited) {
-        // Mark current cell as visited
-        visited[x][y] = true;
-        
-        // If White player reaches rightmost column or Black player reaches bottom row
-        if ((playerType == 1 && y == size - 1) || (playerType == -1 && x == size - 1)) {
-            return true;
+    bool nextBinary(GameRecord& record) {
+        uint64_t fields[7];
+        for (uint64_t& field : fields) {
+            if (!readVarint(field)) return false;
         }
-        
-        // Get all neighboring cells of the same player
-        std::stack<std::pair<int, int>> neighbors = getNeighbours(playerType, x, y);
-        
-        // Explore all unvisited neighbors
-        while (!neighbors.empty()) {
-            auto [nx, ny] = neighbors.top();
-            neighbors.pop();
-            
-            if (!visited[nx][ny]) {
-                if (dfsPathFinding(playerType, nx, ny, visited)) {
-                    return true;
-                }
-            }
+        record.game = static_cast<int>(fields[0]);
+        record.size = static_cast<int>(fields[1]);
+        record.whiteType = static_cast<int>(fields[2]);
+        record.blackType = static_cast<int>(fields[3]);
+        record.seed = static_cast<unsigned int>(fields[4]);
+        record.winner = fields[5] == 1 ? 1 : -1;
+        if (record.size < 1 || record.size > MAX_BOARD_SIZE || fields[6] > static_cast<uint64_t>(MAX_CELLS)) {
+            return false;
         }
-        
-        return false;
+        record.moves.resize(static_cast<size_t>(fields[6]));
+        for (RecordedMove& move : record.moves) {
+            uint64_t cell, playouts, micros;
+            if (!readVarint(cell) || !readVarint(playouts) || !readVarint(micros)) return false;
+            move.cell = static_cast<int>(cell);
+            move.playouts = static_cast<long long>(playouts);
+            move.micros = static_cast<long long>(micros);
+        }
+        return true;
     }
-
-    // For Smart Player: Evaluate board position
-    int evaluatePosition(int playerType) {
-        // Simple evaluation function:
-        // Count stones and give more weight to stones that are advanced toward the goal
-        int score = 0;
-        if (playerType == 1) {  // White player (left to right)
-            for (int i = 0; i < size; i++) {
-                for (int j = 0; j < size; j++) {
-                    if (board[i][j] == playerType) {
-                        score += j + 1;  // More weight to stones closer to right side
-                    } else if (board[i][j] == -playerType) {
-                        score -= j + 1;  // Subtract opponent's progress
-                    }
-                }
-            }
-        } else {  // Black player (top to bottom)
-            for (int i = 0; i < size; i++) {
-                for (int j = 0; j < size; j++) {
-                    if (board[i][j] == playerType) {
-                        score += i + 1;  // More weight to stones closer to bottom
-                    } else if (board[i][j] == -playerType) {
-                        score -= i + 1;  // Subtract opponent's progress
+    
+    bool nextText(GameRecord& record) {
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] != '(') continue;
+            record = GameRecord();
+            
+            // Walk the KEY[value] properties in order
+            size_t pos = 0;
+            while ((pos = line.find('[', pos)) != std::string::npos) {
+                size_t keyStart = pos;
+                while (keyStart > 0 && line[keyStart - 1] >= 'A' && line[keyStart - 1] <= 'Z') keyStart--;
+                size_t close = line.find(']', pos);
+                if (close == std::string::npos) return false;
+                std::string key = line.substr(keyStart, pos - keyStart);
+                std::string value = line.substr(pos + 1, close - pos - 1);
+                pos = close + 1;
+                
+                if (key == "SZ") record.size = std::atoi(value.c_str());
+                else if (key == "GN") record.game = std::atoi(value.c_str());
+                else if (key == "SE") record.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+                else if (key == "RE") record.winner = (value == "W+") ? 1 : -1;
+                else if (key == "PW" || key == "PB") {
+                    int type = 0;
+                    for (int t = 0; t <= 5; t++) {
+                        if (value == playerTypeName(t)) type = t;
                     }
+                    (key == "PW" ? record.whiteType : record.blackType) = type;
+                } else if (key == "W" || key == "B") {
+                    if (record.size < 1 || record.size > MAX_BOARD_SIZE) return false;
+                    RecordedMove move;
+                    move.cell = parseRecordCellName(value, record.size);
+                    if (move.cell < 0) return false;
+                    record.moves.push_back(move);
+                } else if (key == "XP" && !record.moves.empty()) {
+                    record.moves.back().playouts = std::atoll(value.c_str());
+                } else if (key == "XT" && !record.moves.empty()) {
+                    record.moves.back().micros = std::atoll(value.c_str());
                 }
             }
+            return record.size >= 1 && record.size <= MAX_BOARD_SIZE;
         }
-        return score;
+        return false;
     }
 };
 
-// Human Player class
-class HumanPlayer : public Player {
+// Per-move telemetry, written as JSON lines: one object per move with the
+// figures the player reports (playouts or nodes, depth, table hits), the
+// time spent in each phase and how often each counted operation ran. Safe
+// to share between the games of a parallel match.
+class TelemetryLog {
 private:
-    Board& board;
-    int playerType;
+    std::ofstream file;
+    std::mutex mutex;
+    bool allThreads;
     
 public:
-    HumanPlayer(Board& b, int type) : board(b), playerType(type) {}
+    explicit TelemetryLog(const std::string& path) : file(path, std::ios::trunc), allThreads(true) {}
     
-    std::pair<int, int> getMove() override {
-        int x, y;
-        std::cout << "Enter your move (row column): ";
-        std::cin >> x >> y;
-        
-        // Convert to 0-indexed
-        x--;
-        y--;
-        
-        // Validate the move
-        while (!board.isValidMove(x, y)) {
-            std::cout << "Invalid move. Try again: ";
-            std::cin >> x >> y;
-            x--;
-            y--;
-        }
-        
-        return {x, y};
+    bool isOpen() const {
+        return static_cast<bool>(file);
     }
-};
-
-// Task 2: Random Player implementation
-class RandomPlayer : public Player {
-private:
-    Board& board;
-    int playerType;
     
-public:
-    RandomPlayer(Board& b, int type) : board(b), playerType(type) {
-        // Seed the random number generator
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
+    // Count the work of every thread (right when one game runs at a time, so
+    // a player's own worker threads are included) or only of the thread that
+    // plays the game (parallel games)
+    void setAllThreads(bool enabled) {
+        allThreads = enabled;
     }
     
-    std::pair<int, int> getMove() override {
-        // Efficient approach: Create list of all empty cells, then choose randomly
-        std::vector<std::pair<int, int>> emptyCells;
-        int size = board.getSize();
+    TelemetrySnapshot snapshot() const {
+        return Telemetry::snapshot(allThreads);
+    }
+    
+    // Log the last move of 'game', played by 'playerType' with the given
+    // search statistics and the telemetry accumulated while choosing it
+    void write(const GameRecord& game, int playerType, const SearchStats* stats, const TelemetrySnapshot& work) {
+        const RecordedMove& move = game.moves.back();
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3)
+             << "{\"game\":" << game.game << ",\"move\":" << game.moves.size()
+             << ",\"side\":\"" << (playerType == 1 ? "white" : "black") << "\",\"player\":\""
+             << playerTypeName(playerType == 1 ? game.whiteType : game.blackType)
+             << "\",\"cell\":\"" << recordCellName(move.cell, game.size) << "\",\"ms\":" << move.micros / 1000.0;
+        if (stats) {
+            line << ",\"" << (stats->depth > 0 ? "nodes" : "playouts") << "\":" << stats->playouts;
+            if (stats->depth > 0) line << ",\"depth\":" << stats->depth;
+            line << ",\"table_hits\":" << stats->tableHits << ",\"book\":" << (stats->fromBook ? "true" : "false");
+        }
+        line << ",\"phase_ms\":{";
+        for (int i = 0; i < NUM_PHASES; i++) {
+            line << (i ? "," : "") << "\"" << PHASE_NAMES[i] << "\":" << work.phaseNanos[i] / 1e6;
+        }
+        line << "},\"counts\":{";
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            line << (i ? "," : "") << "\"" << COUNTER_NAMES[i] << "\":" << work.counts[i];
+        }
+        line << "}}\n";
         
-        // Find all empty cells
-        for (int i = 0; i < size; i++) {
-            for (int j = 0; j < size; j++) {
-                if (board.isValidMove(i, j)) {
-                    emptyCells.push_back({i, j});
-                }
+        std::lock_guard<std::mutex> lock(mutex);
+        file << line.str();
+        file.flush();
+    }
+};
+
+// Play one game between two players bound to 'board' and return the winner.
+// A player that returns an illegal move loses. 'moves' receives the number
+// of moves played; 'record', if given, receives the moves, the winner and
+// the search work behind every move. 'telemetry', if given, logs every move;
+// it needs 'record', whose game number and player types it reports.
+int playHeadlessGame(Board& board, Player& white, Player& black, int* moves = nullptr,
+                     GameRecord* record = nullptr, TelemetryLog* telemetry = nullptr) {
+    int current = 1;
+    int played = 0;
+    while (true) {
+        Player& player = (current == 1) ? white : black;
+        TelemetrySnapshot before;
+        if (telemetry) before = telemetry->snapshot();
+        auto start = std::chrono::steady_clock::now();
+        std::pair<int, int> move;
+        {
+            NASH_PHASE(PHASE_SEARCH);
+            move = player.getMove();
+        }
+        TelemetrySnapshot work;
+        if (telemetry) work = telemetry->snapshot() - before;
+        if (!board.makeMove(move.first, move.second, current)) {
+            if (moves) *moves = played;
+            if (record) record->winner = -current;
+            return -current;
+        }
+        played++;
+        if (record) {
+            RecordedMove recorded;
+            recorded.cell = move.first * board.getSize() + move.second;
+            recorded.micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (const SearchStats* stats = player.getSearchStats()) {
+                recorded.playouts = stats->playouts;
+            }
+            record->moves.push_back(recorded);
+            if (telemetry) {
+                telemetry->write(*record, current, player.getSearchStats(), work);
             }
         }
-        
-        // Select a random cell from available empty cells
-        if (!emptyCells.empty()) {
-            int index = std::rand() % emptyCells.size();
-            return emptyCells[index];
+        if (board.hasWon(current)) {
+            if (moves) *moves = played;
+            if (record) record->winner = current;
+            return current;
         }
-        
-        // Fallback (should not happen with proper game termination)
-        return {-1, -1};
+        current = -current;
     }
+}
+
+// Settings for a batch of games between player types A and B
+struct MatchConfig {
+    int size = 7;
+    int typeA = 1;
+    int typeB = 1;
+    int games = 100;
+    int threads = 1;            // Games played in parallel
+    bool swapSides = true;      // A plays White in even games and Black in odd ones
+    unsigned int seed = 1;      // Base seed; each game derives its own
+    PlayerSettings players;     // Budget and threads inside each player (seed is ignored)
+    GameRecordWriter* recorder = nullptr;   // Receives every finished game, if set
+    TelemetryLog* telemetry = nullptr;      // Receives every move, if set
 };
 
-// Task 6: Smart Player implementation
-class SmartPlayer : public Player {
-private:
-    Board& board;
-    int playerType;
+// Outcome of a match, from player A's point of view
+struct MatchResult {
+    int games = 0;
+    int winsA = 0;
+    int winsB = 0;
+    int gamesAsWhiteA = 0;      // Games in which A played White
+    int winsAsWhiteA = 0;
+    int winsAsBlackA = 0;
+    int whiteWins = 0;          // Games won by whichever side played White
+    long long moves = 0;
+    double seconds = 0.0;
     
-public:
-    SmartPlayer(Board& b, int type) : board(b), playerType(type) {}
+    double winRateA() const {
+        return games > 0 ? static_cast<double>(winsA) / games : 0.0;
+    }
     
-    std::pair<int, int> getMove() override {
-        int size = board.getSize();
-        std::pair<int, int> bestMove = {-1, -1};
-        int bestScore = -999999;
-        
-        // Try each possible move and evaluate
-        for (int i = 0; i < size; i++) {
-            for (int j = 0; j < size; j++) {
-                if (board.isValidMove(i, j)) {
-                    // Make temporary move
-                    board.makeMove(i, j, playerType);
-                    
-                    // Evaluate the position after this move
-                    int score = evaluateMove(i, j);
-                    
-                    // Undo the move
-                    board.makeMove(i, j, 0);
-                    
-                    // Update best move if needed
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestMove = {i, j};
-                    }
-                }
-            }
-        }
-        
-        return bestMove;
+    double gamesPerSecond() const {
+        return seconds > 0.0 ? games / seconds : 0.0;
     }
     
-    // Evaluate a move based on various factors
-    int evaluateMove(int x, int y) {
-        int score = 0;
-        int size = board.getSize();
-        
-        // Check if this move would create a win
-        if (board.hasWon(playerType)) {
-            return 10000;  // Very high score for winning move
-        }
-        
-        // Get connected neighbors with the same stone
-        std::stack<std::pair<int, int>> neighbors = board.getNeighbours(playerType, x, y);
-        score += neighbors.size() * 10;  // More neighbors is good
-        
-        // Position-based evaluation
-        if (playerType == 1) {  // White player (left to right)
-            score += y * 5;  // Prefer moves closer to right side
-        } else {  // Black player (top to bottom)
-            score += x * 5;  // Prefer moves closer to bottom
+    // 95% Wilson score interval for A's win rate
+    void winRateInterval(double& low, double& high) const {
+        const double z = 1.96;
+        if (games == 0) {
+            low = 0.0;
+            high = 1.0;
+            return;
         }
-        
-        // Use the board's evaluation function
-        score += board.evaluatePosition(playerType);
-        
-        return score;
+        double p = winRateA();
+        double n = games;
+        double denominator = 1.0 + z * z / n;
+        double centre = (p + z * z / (2.0 * n)) / denominator;
+        double halfWidth = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denominator;
+        low = std::max(0.0, centre - halfWidth);
+        high = std::min(1.0, centre + halfWidth);
     }
 };
 
-// Task 7: Monte Carlo Player implementation
-class MonteCarloPlayer : public Player {
+// Headless match runner: every game gets its own board and freshly created
+// players, games run in parallel on a thread pool, and each player's seed is
+// derived from the match seed and the game number, so a match can be
+// reproduced exactly regardless of the number of threads.
+class MatchRunner {
 private:
-    Board& board;
-    int playerType;
-    const int SIMULATIONS = 100;  // Number of simulations per move
+    MatchConfig config;
     
 public:
-    MonteCarloPlayer(Board& b, int type) : board(b), playerType(type) {
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
-    }
-    
-    std::pair<int, int> getMove() override {
-        int size = board.getSize();
-        std::pair<int, int> bestMove = {-1, -1};
-        int bestWins = -1;
-        
-        // Try each possible move
-        for (int i = 0; i < size; i++) {
-            for (int j = 0; j < size; j++) {
-                if (board.isValidMove(i, j)) {
-                    // Make temporary move
-                    board.makeMove(i, j, playerType);
-                    
-                    // Run Monte Carlo simulations
-                    int wins = runSimulations();
-                    
-                    // Undo the move
-                    board.makeMove(i, j, 0);
-                    
-                    // Update best move if needed
-                    if (wins > bestWins) {
-                        bestWins = wins;
-                        bestMove = {i, j};
-                    }
-                }
-            }
-        }
-        
-        return bestMove;
-    }
+    explicit MatchRunner(const MatchConfig& matchConfig) : config(matchConfig) {}
     
-    // Run simulations and return the number of wins
-    int runSimulations() {
-        int wins = 0;
+    MatchResult run() {
+        struct GameOutcome {
+            bool aWasWhite;
+            int winner;
+            int moves;
+        };
+        std::vector<GameOutcome> outcomes(std::max(0, config.games));
         
-        for (int sim = 0; sim < SIMULATIONS; sim++) {
-            // Create a copy of the current board for simulations
-            Board tempBoard = board;
+        auto start = std::chrono::steady_clock::now();
+        ThreadPool pool(config.threads);
+        pool.run(config.games, [&](int game, int) {
+            Board board(config.size);
+            bool aWasWhite = !config.swapSides || game % 2 == 0;
             
-            // Current player (alternating)
-            int currentPlayer = -playerType;  // Start with opponent
+            PlayerSettings settingsA = config.players;
+            PlayerSettings settingsB = config.players;
+            settingsA.seed = mixSeed(config.seed, 2 * static_cast<uint64_t>(game));
+            settingsB.seed = mixSeed(config.seed, 2 * static_cast<uint64_t>(game) + 1);
+            std::unique_ptr<Player> playerA(createPlayer(config.typeA, board, aWasWhite ? 1 : -1, settingsA));
+            std::unique_ptr<Player> playerB(createPlayer(config.typeB, board, aWasWhite ? -1 : 1, settingsB));
             
-            // Play random moves until someone wins or board is full
-            while (true) {
-                // Check if current player has won
-                if (tempBoard.hasWon(currentPlayer)) {
-                    if (currentPlayer == playerType) {
-                        wins++;
-                    }
-                    break;
-                }
-                
-                // Check if board is full
-                if (tempBoard.isFull()) {
-                    break;
-                }
-                
-                // Make a random move
-                std::vector<std::pair<int, int>> emptyCells;
-                int size = tempBoard.getSize();
-                for (int i = 0; i < size; i++) {
-                    for (int j = 0; j < size; j++) {
-                        if (tempBoard.isValidMove(i, j)) {
-                            emptyCells.push_back({i, j});
-                        }
-                    }
-                }
-                
-                if (!emptyCells.empty()) {
-                    int index = std::rand() % emptyCells.size();
-                    auto [x, y] = emptyCells[index];
-                    tempBoard.makeMove(x, y, currentPlayer);
+            Player& white = aWasWhite ? *playerA : *playerB;
+            Player& black = aWasWhite ? *playerB : *playerA;
+            int moves = 0;
+            GameRecord record;
+            record.game = game;
+            record.size = config.size;
+            record.whiteType = aWasWhite ? config.typeA : config.typeB;
+            record.blackType = aWasWhite ? config.typeB : config.typeA;
+            record.seed = config.seed;
+            bool keepRecord = config.recorder || config.telemetry;
+            int winner = playHeadlessGame(board, white, black, &moves, keepRecord ? &record : nullptr,
+                                          config.telemetry);
+            outcomes[game] = {aWasWhite, winner, moves};
+            if (config.recorder) {
+                config.recorder->write(record);
+            }
+        });
+        
+        MatchResult result;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const GameOutcome& outcome : outcomes) {
+            bool aWon = (outcome.winner == 1) == outcome.aWasWhite;
+            result.games++;
+            result.moves += outcome.moves;
+            if (outcome.winner == 1) result.whiteWins++;
+            if (outcome.aWasWhite) result.gamesAsWhiteA++;
+            if (aWon) {
+                result.winsA++;
+                if (outcome.aWasWhite) {
+                    result.winsAsWhiteA++;
+                } else {
+                    result.winsAsBlackA++;
                 }
-                
-                // Switch player
-                currentPlayer = -currentPlayer;
+            } else {
+                result.winsB++;
             }
         }
-        
-        return wins;
+        return result;
     }
 };
 
+// Print a human-readable match summary
+void printMatchResult(std::ostream& out, const MatchConfig& config, const MatchResult& result) {
+    double low;
+    double high;
+    result.winRateInterval(low, high);
+    out << std::fixed << std::setprecision(1);
+    out << "Results after " << result.games << " games on " << config.size << "x" << config.size
+              << " (seed " << config.seed << "):" << std::endl;
+    out << "Player A (" << playerTypeName(config.typeA) << ") wins: " << result.winsA
+              << " (" << 100.0 * result.winRateA() << "%, 95% CI "
+              << 100.0 * low << "-" << 100.0 * high << "%)" << std::endl;
+    out << "  as White: " << result.winsAsWhiteA << "/" << result.gamesAsWhiteA
+              << ", as Black: " << result.winsAsBlackA << "/" << result.games - result.gamesAsWhiteA << std::endl;
+    out << "Player B (" << playerTypeName(config.typeB) << ") wins: " << result.winsB << std::endl;
+    out << "White won " << result.whiteWins << " of " << result.games << " games" << std::endl;
+    out << "Throughput: " << result.gamesPerSecond() << " games/sec, "
+              << (result.games > 0 ? static_cast<double>(result.moves) / result.games : 0.0)
+              << " moves/game" << std::endl;
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
+
 // Nash Game class to manage the game
 class NashGame {
 private:
@@ -529,11 +3893,28 @@ private:
     Player* player1;  // White player
     Player* player2;  // Black player
     int currentPlayer;
+    int player1Type;
+    int player2Type;
+    PlayerSettings settings;  // Threads and budget for computer players
+    GameRecordWriter* recorder = nullptr;  // Receives finished games, if set
+    TelemetryLog* telemetry = nullptr;     // Receives every move, if set
     
 public:
-    NashGame(int size, int p1Type, int p2Type) : board(size), currentPlayer(1) {
+    NashGame(int size, int p1Type, int p2Type, int numThreads = 1,
+             const SearchBudget& searchBudget = SearchBudget(),
+             unsigned int seed = static_cast<unsigned int>(std::time(nullptr)))
+        : board(size), currentPlayer(1), player1Type(p1Type), player2Type(p2Type) {
+        settings.threads = numThreads;
+        settings.budget = searchBudget;
+        settings.seed = seed;
         // Create players based on types
-        // 0: Human, 1: Random, 2: Smart, 3: Monte Carlo
+        // 0: Human, 1: Random, 2: Smart, 3: Monte Carlo, 4: MCTS, 5: Alpha-beta
+        createPlayers(p1Type, p2Type);
+    }
+    
+    // Same, with every computer-player setting given explicitly
+    NashGame(int size, int p1Type, int p2Type, const PlayerSettings& playerSettings)
+        : board(size), currentPlayer(1), player1Type(p1Type), player2Type(p2Type), settings(playerSettings) {
         createPlayers(p1Type, p2Type);
     }
     
@@ -543,45 +3924,31 @@ public:
     }
     
     void createPlayers(int p1Type, int p2Type) {
-        // Create player 1 (White)
-        switch (p1Type) {
-            case 0:
-                player1 = new HumanPlayer(board, 1);
-                break;
-            case 1:
-                player1 = new RandomPlayer(board, 1);
-                break;
-            case 2:
-                player1 = new SmartPlayer(board, 1);
-                break;
-            case 3:
-                player1 = new MonteCarloPlayer(board, 1);
-                break;
-            default:
-                player1 = new HumanPlayer(board, 1);
-        }
-        
-        // Create player 2 (Black)
-        switch (p2Type) {
-            case 0:
-                player2 = new HumanPlayer(board, -1);
-                break;
-            case 1:
-                player2 = new RandomPlayer(board, -1);
-                break;
-            case 2:
-                player2 = new SmartPlayer(board, -1);
-                break;
-            case 3:
-                player2 = new MonteCarloPlayer(board, -1);
-                break;
-            default:
-                player2 = new HumanPlayer(board, -1);
-        }
+        // Player 1 is White, player 2 is Black; each gets its own seed
+        PlayerSettings playerSettings = settings;
+        playerSettings.seed = mixSeed(settings.seed, 0);
+        player1 = createPlayer(p1Type, board, 1, playerSettings);
+        playerSettings.seed = mixSeed(settings.seed, 1);
+        player2 = createPlayer(p2Type, board, -1, playerSettings);
+    }
+    
+    // Write every game played from now on to 'writer' (nullptr to stop)
+    void setRecorder(GameRecordWriter* writer) {
+        recorder = writer;
+    }
+    
+    // Log every move played from now on to 'log' (nullptr to stop)
+    void setTelemetry(TelemetryLog* log) {
+        telemetry = log;
     }
     
     void play() {
         bool gameOver = false;
+        GameRecord record;
+        record.size = board.getSize();
+        record.whiteType = player1Type;
+        record.blackType = player2Type;
+        record.seed = settings.seed;
         
         while (!gameOver) {
             // Display the board
@@ -594,7 +3961,16 @@ public:
             std::cout << playerName << "'s turn." << std::endl;
             
             // Get the move from the current player
-            std::pair<int, int> move = currentPlayerObj->getMove();
+            TelemetrySnapshot before;
+            if (telemetry) before = telemetry->snapshot();
+            auto moveStart = std::chrono::steady_clock::now();
+            std::pair<int, int> move;
+            {
+                NASH_PHASE(PHASE_SEARCH);
+                move = currentPlayerObj->getMove();
+            }
+            TelemetrySnapshot work;
+            if (telemetry) work = telemetry->snapshot() - before;
             int x = move.first;
             int y = move.second;
             
@@ -602,6 +3978,38 @@ public:
             if (board.makeMove(x, y, currentPlayer)) {
                 std::cout << playerName << " places at (" << x + 1 << "," << y + 1 << ")" << std::endl;
                 
+                RecordedMove recorded;
+                recorded.cell = x * board.getSize() + y;
+                recorded.micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - moveStart).count();
+                if (const SearchStats* stats = currentPlayerObj->getSearchStats()) {
+                    recorded.playouts = stats->playouts;
+                }
+                record.moves.push_back(recorded);
+                if (telemetry) {
+                    telemetry->write(record, currentPlayer, currentPlayerObj->getSearchStats(), work);
+                }
+                
+                // Report how much searching the move took
+                if (const SearchStats* stats = currentPlayerObj->getSearchStats()) {
+                    if (stats->fromBook) {
+                        std::cout << playerName << " played from the opening book";
+                    } else if (stats->depth > 0) {
+                        std::cout << playerName << " searched " << stats->playouts << " nodes to depth "
+                                  << stats->depth << " in " << static_cast<int>(stats->seconds * 1000.0) << " ms ("
+                                  << static_cast<long long>(stats->playouts / std::max(stats->seconds, 1e-6))
+                                  << " nodes/s, effective branching factor " << std::fixed << std::setprecision(1)
+                                  << stats->branchingFactor << std::defaultfloat << ")";
+                    } else {
+                        std::cout << playerName << " searched " << stats->playouts << " playouts in "
+                                  << static_cast<int>(stats->seconds * 1000.0) << " ms";
+                    }
+                    if (stats->tableHits > 0) {
+                        std::cout << " (" << stats->tableHits << " transposition table hits)";
+                    }
+                    std::cout << std::endl;
+                }
+                
                 // Show neighbors for demonstration (Task 4)
                 board.printNeighbours(x, y);
                 
@@ -610,6 +4018,7 @@ public:
                     board.display();
                     std::cout << playerName << " wins with a straight line!" << std::endl;
                     gameOver = true;
+                    record.winner = currentPlayer;
                     continue;
                 }
                 
@@ -618,6 +4027,7 @@ public:
                     board.display();
                     std::cout << playerName << " wins!" << std::endl;
                     gameOver = true;
+                    record.winner = currentPlayer;
                     continue;
                 }
                 
@@ -635,66 +4045,1269 @@ public:
                 std::cout << "Invalid move. Try again." << std::endl;
             }
         }
+        
+        if (recorder && record.winner != 0) {
+            recorder->write(record);
+        }
     }
     
     // For Task 7: Run multiple games between computer players
+    // Games are played headlessly by MatchRunner, each with its own board and
+    // players, in parallel, with the players swapping colours every game.
+    // Players keep the worker threads chosen for them, and the cores left
+    // over are split between games, so games x player threads <= cores.
     void runMultipleGames(int numGames) {
-        int player1Wins = 0;
-        int player2Wins = 0;
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        MatchConfig config;
+        config.size = board.getSize();
+        config.typeA = player1Type;
+        config.typeB = player2Type;
+        config.games = numGames;
+        config.threads = std::max(1, cores / std::max(1, settings.threads));
+        config.seed = settings.seed;
+        config.players = settings;
+        config.recorder = recorder;
+        config.telemetry = telemetry;
+        
+        std::cout << "Playing " << numGames << " games, " << config.threads << " at a time, with "
+                  << config.players.threads << " worker thread(s) per Monte Carlo player" << std::endl;
+        MatchResult result = MatchRunner(config).run();
+        printMatchResult(std::cout, config, result);
+    }
+};
+
+// A table of results that can be written as aligned text, CSV or JSON
+// (an array of objects, one per row)
+class ResultTable {
+public:
+    struct Value {
+        std::string text;
+        bool numeric;
+        
+        Value(const char* value) : text(value), numeric(false) {}
+        Value(const std::string& value) : text(value), numeric(false) {}
+        Value(int value) : text(std::to_string(value)), numeric(true) {}
+        Value(long long value) : text(std::to_string(value)), numeric(true) {}
+        Value(double value) : numeric(true) {
+            std::ostringstream out;
+            out << std::setprecision(6) << value;
+            text = out.str();
+        }
+    };
+    
+private:
+    std::vector<std::string> columns;
+    std::vector<std::vector<Value>> rows;
+    
+public:
+    explicit ResultTable(const std::vector<std::string>& columnNames) : columns(columnNames) {}
+    
+    void addRow(const std::vector<Value>& values) {
+        rows.push_back(values);
+    }
+    
+    void write(std::ostream& out, const std::string& format) const {
+        if (format == "json") {
+            out << "[" << std::endl;
+            for (size_t r = 0; r < rows.size(); r++) {
+                out << "  {";
+                for (size_t c = 0; c < columns.size(); c++) {
+                    const Value& value = rows[r][c];
+                    out << (c ? ", " : "") << "\"" << columns[c] << "\": ";
+                    if (value.numeric) {
+                        out << value.text;
+                    } else {
+                        out << "\"" << escapeJson(value.text) << "\"";
+                    }
+                }
+                out << "}" << (r + 1 < rows.size() ? "," : "") << std::endl;
+            }
+            out << "]" << std::endl;
+        } else if (format == "csv") {
+            for (size_t c = 0; c < columns.size(); c++) {
+                out << (c ? "," : "") << columns[c];
+            }
+            out << std::endl;
+            for (const std::vector<Value>& row : rows) {
+                for (size_t c = 0; c < columns.size(); c++) {
+                    out << (c ? "," : "") << row[c].text;
+                }
+                out << std::endl;
+            }
+        } else {
+            std::vector<size_t> widths(columns.size());
+            for (size_t c = 0; c < columns.size(); c++) {
+                widths[c] = columns[c].size();
+                for (const std::vector<Value>& row : rows) {
+                    widths[c] = std::max(widths[c], row[c].text.size());
+                }
+            }
+            for (size_t c = 0; c < columns.size(); c++) {
+                out << std::left << std::setw(static_cast<int>(widths[c]) + 2) << columns[c];
+            }
+            out << std::endl;
+            for (const std::vector<Value>& row : rows) {
+                for (size_t c = 0; c < columns.size(); c++) {
+                    out << std::left << std::setw(static_cast<int>(widths[c]) + 2) << row[c].text;
+                }
+                out << std::endl;
+            }
+            out << std::right;
+        }
+    }
+    
+private:
+    static std::string escapeJson(const std::string& text) {
+        std::string escaped;
+        for (char ch : text) {
+            if (ch == '"' || ch == '\\') escaped += '\\';
+            escaped += ch;
+        }
+        return escaped;
+    }
+};
+
+// Write a match result as one table row (used for CSV and JSON output)
+void writeMatchResult(std::ostream& out, const std::string& format,
+                      const MatchConfig& config, const MatchResult& result) {
+    double low;
+    double high;
+    result.winRateInterval(low, high);
+    ResultTable table({"size", "player_a", "player_b", "games", "seed", "wins_a", "wins_b",
+                       "win_rate_a", "ci95_low", "ci95_high", "wins_a_as_white", "wins_a_as_black",
+                       "white_wins", "seconds", "games_per_sec", "moves_per_game"});
+    table.addRow({config.size, playerTypeName(config.typeA), playerTypeName(config.typeB),
+                  result.games, static_cast<long long>(config.seed), result.winsA, result.winsB,
+                  result.winRateA(), low, high, result.winsAsWhiteA, result.winsAsBlackA,
+                  result.whiteWins, result.seconds, result.gamesPerSecond(),
+                  result.games > 0 ? static_cast<double>(result.moves) / result.games : 0.0});
+    table.write(out, format);
+}
+
+// Replay a record on a fresh board. True if every move is legal, nobody wins
+// before the last move, and the last move wins the game for the recorded winner.
+bool replayRecord(const GameRecord& record, Board& board) {
+    for (size_t i = 0; i < record.moves.size(); i++) {
+        int player = (i % 2 == 0) ? 1 : -1;
+        int cell = record.moves[i].cell;
+        if (cell < 0 || cell >= record.size * record.size
+            || !board.makeMove(cell / record.size, cell % record.size, player)) {
+            return false;
+        }
+        bool last = i + 1 == record.moves.size();
+        if (board.hasWon(player) != last) {
+            return false;
+        }
+    }
+    return !record.moves.empty() && record.winner == ((record.moves.size() % 2 == 1) ? 1 : -1);
+}
+
+// Replay mode: read game records back, check each one by replaying it, and
+// summarise them per board size and pairing. With 'game' >= 0, show that game
+// board by board instead.
+int runReplay(std::ostream& out, const std::string& format, const std::string& path, int game) {
+    GameRecordReader reader(path);
+    if (!reader.isOpen()) {
+        std::cerr << "Error: cannot read '" << path << "'" << std::endl;
+        return 1;
+    }
+    
+    struct Summary {
+        int games = 0;
+        int whiteWins = 0;
+        int invalid = 0;
+        long long moves = 0;
+        long long playouts[2] = {0, 0};     // White, Black
+        long long micros[2] = {0, 0};
+        long long sideMoves[2] = {0, 0};
+    };
+    std::map<std::tuple<int, int, int>, Summary> summaries;
+    
+    GameRecord record;
+    while (reader.next(record)) {
+        if (game >= 0) {
+            if (record.game != game) continue;
+            Board board(record.size);
+            board.display();
+            for (size_t i = 0; i < record.moves.size(); i++) {
+                int cell = record.moves[i].cell;
+                int player = (i % 2 == 0) ? 1 : -1;
+                if (cell < 0 || cell >= record.size * record.size
+                    || !board.makeMove(cell / record.size, cell % record.size, player)) {
+                    out << "Invalid move " << i + 1 << " in the record" << std::endl;
+                    return 1;
+                }
+                out << (player == 1 ? "White" : "Black") << " places at (" << cell / record.size + 1 << ","
+                    << cell % record.size + 1 << ")";
+                if (record.moves[i].playouts > 0) {
+                    out << " after " << record.moves[i].playouts << " playouts";
+                }
+                out << " in " << record.moves[i].micros / 1000 << " ms" << std::endl;
+                board.display();
+            }
+            out << (record.winner == 1 ? "White" : "Black") << " wins!" << std::endl;
+            return 0;
+        }
+        
+        Summary& summary = summaries[std::make_tuple(record.size, record.whiteType, record.blackType)];
+        Board board(record.size);
+        summary.games++;
+        if (record.winner == 1) summary.whiteWins++;
+        if (!replayRecord(record, board)) summary.invalid++;
+        summary.moves += static_cast<long long>(record.moves.size());
+        for (size_t i = 0; i < record.moves.size(); i++) {
+            int side = static_cast<int>(i % 2);
+            summary.playouts[side] += record.moves[i].playouts;
+            summary.micros[side] += record.moves[i].micros;
+            summary.sideMoves[side]++;
+        }
+    }
+    if (game >= 0) {
+        std::cerr << "Error: game " << game << " is not in '" << path << "'" << std::endl;
+        return 1;
+    }
+    
+    if (format == "text") {
+        out << "Game records in " << path << std::endl;
+    }
+    ResultTable table({"size", "white", "black", "games", "white_wins", "white_win_rate", "moves_per_game",
+                       "white_playouts_per_move", "black_playouts_per_move",
+                       "white_ms_per_move", "black_ms_per_move", "invalid"});
+    for (const auto& [key, summary] : summaries) {
+        auto perMove = [&](const long long* totals, int side, double scale) {
+            return summary.sideMoves[side] > 0 ? totals[side] * scale / summary.sideMoves[side] : 0.0;
+        };
+        table.addRow({std::get<0>(key), playerTypeName(std::get<1>(key)), playerTypeName(std::get<2>(key)),
+                      summary.games, summary.whiteWins, static_cast<double>(summary.whiteWins) / summary.games,
+                      static_cast<double>(summary.moves) / summary.games,
+                      perMove(summary.playouts, 0, 1.0), perMove(summary.playouts, 1, 1.0),
+                      perMove(summary.micros, 0, 0.001), perMove(summary.micros, 1, 0.001), summary.invalid});
+    }
+    table.write(out, format);
+    return 0;
+}
+
+// Compare search players with and without RAVE at several playout budgets:
+// first at equal budgets, then RAVE against plain search with 4x the playouts
+void runRaveBenchmark(std::ostream& out, const std::string& format) {
+    const int SIZE = 7;
+    const int GAMES = 40;
+    if (format == "text") {
+        out << "RAVE benchmark (" << SIZE << "x" << SIZE << ", " << GAMES
+            << " games per row, colours alternate)" << std::endl;
+    }
+    
+    ResultTable table({"player", "rave_playouts", "plain_playouts", "games", "rave_wins", "rave_win_rate"});
+    for (int kind = 0; kind < 2; kind++) {
+        for (int ratio : {1, 4}) {
+            for (long long playouts : {100LL, 400LL, 1600LL}) {
+                int raveWins = 0;
+                for (int game = 0; game < GAMES; game++) {
+                    Board board(SIZE);
+                    int raveSide = (game % 2 == 0) ? 1 : -1;
+                    unsigned int seed = static_cast<unsigned int>(game * 2 + 1);
+                    std::unique_ptr<SearchPlayer> ravePlayer;
+                    std::unique_ptr<SearchPlayer> plainPlayer;
+                    if (kind == 0) {
+                        auto withRave = std::make_unique<MonteCarloPlayer>(board, raveSide, 1, seed);
+                        auto without = std::make_unique<MonteCarloPlayer>(board, -raveSide, 1, seed + 1);
+                        without->setRave(false);
+                        ravePlayer = std::move(withRave);
+                        plainPlayer = std::move(without);
+                    } else {
+                        auto withRave = std::make_unique<MctsPlayer>(board, raveSide, seed);
+                        auto without = std::make_unique<MctsPlayer>(board, -raveSide, seed + 1);
+                        without->setRave(false);
+                        ravePlayer = std::move(withRave);
+                        plainPlayer = std::move(without);
+                    }
+                    SearchBudget raveBudget;
+                    raveBudget.playouts = playouts;
+                    SearchBudget plainBudget;
+                    plainBudget.playouts = playouts * ratio;
+                    ravePlayer->setBudget(raveBudget);
+                    plainPlayer->setBudget(plainBudget);
+                    
+                    Player& white = (raveSide == 1) ? *ravePlayer : *plainPlayer;
+                    Player& black = (raveSide == 1) ? *plainPlayer : *ravePlayer;
+                    if (playHeadlessGame(board, white, black) == raveSide) {
+                        raveWins++;
+                    }
+                }
+                table.addRow({(kind == 0) ? "Monte Carlo" : "MCTS", playouts, playouts * ratio,
+                              GAMES, raveWins, static_cast<double>(raveWins) / GAMES});
+            }
+        }
+    }
+    table.write(out, format);
+}
+
+// Benchmark suite
+// Each board primitive is timed on a fixed, seeded mid-game position for every
+// requested board size. A measurement is the median of several equally sized
+// samples, so numbers from different builds can be compared directly.
+
+// Results of benchmarked calls are added here so the calls cannot be optimised away
+volatile long long benchmarkSink = 0;
+
+// Median nanoseconds per call of 'op' over 'samples' samples of about sampleMs each
+template <class Operation>
+double measureNanosPerCall(Operation&& op, int sampleMs, int samples) {
+    using Clock = std::chrono::steady_clock;
+    
+    // Calibrate the iteration count once so every sample does the same work
+    long long iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        for (long long i = 0; i < iterations; i++) op();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (ms >= sampleMs / 4.0) {
+            iterations = std::max(1LL, static_cast<long long>(iterations * sampleMs / ms));
+            break;
+        }
+        iterations *= 2;
+    }
+    
+    std::vector<double> nanos;
+    for (int sample = 0; sample < samples; sample++) {
+        auto start = Clock::now();
+        for (long long i = 0; i < iterations; i++) op();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        nanos.push_back(ns / iterations);
+    }
+    std::sort(nanos.begin(), nanos.end());
+    return nanos[nanos.size() / 2];
+}
+
+// A reproducible position with about 40% of the cells filled, alternating
+// colours, and no winner yet
+Board makeBenchmarkPosition(int size, unsigned int seed) {
+    Board board(size);
+    Rng rng(seed);
+    std::vector<int> cells;
+    board.getEmptyCells(cells);
+    std::shuffle(cells.begin(), cells.end(), rng);
+    int player = 1;
+    int target = size * size * 2 / 5;
+    for (int i = 0, placed = 0; i < static_cast<int>(cells.size()) && placed < target; i++) {
+        int x = cells[i] / size;
+        int y = cells[i] % size;
+        board.makeMove(x, y, player);
+        if (board.hasWon(player)) {
+            board.makeMove(x, y, 0);
+            continue;
+        }
+        placed++;
+        player = -player;
+    }
+    return board;
+}
+
+// Time every board primitive and a full random playout on each board size
+void runBenchmarkSuite(std::ostream& out, const std::string& format,
+                       const std::vector<int>& sizes, int sampleMs) {
+    const int SAMPLES = 5;
+    if (format == "text") {
+        out << "Benchmark suite (median of " << SAMPLES << " samples of " << sampleMs
+            << " ms, seeded mid-game positions)" << std::endl;
+    }
+    
+    ResultTable table({"size", "operation", "ns_per_op", "ops_per_sec"});
+    for (int size : sizes) {
+        Board position = makeBenchmarkPosition(size, 12345u + size);
+        const Board emptyBoard(size);
+        std::vector<int> emptyCells;
+        position.getEmptyCells(emptyCells);
+        PlayoutEngine engine(12345u);
+        RandomPlayer randomPlayer(position, 1, 12345u);
+        int next = 0;
         
-        for (int game = 0; game < numGames; game++) {
-            // Create a new board for each game
-            Board newBoard(board.getSize());
+        std::vector<std::pair<std::string, std::function<void()>>> operations = {
+            {"board_copy", [&] {
+                Board copy = position;
+                benchmarkSink += copy.getValue(0, 0);
+            }},
+            {"make_undo", [&] {
+                int cell = emptyCells[next++ % emptyCells.size()];
+                position.makeMove(cell / size, cell % size, 1);
+                position.makeMove(cell / size, cell % size, 0);
+            }},
+            {"has_won", [&] {
+                benchmarkSink += position.hasWon((next++ & 1) ? 1 : -1);
+            }},
+            {"has_won_flood_fill", [&] {
+                benchmarkSink += position.hasWonByFloodFill((next++ & 1) ? 1 : -1);
+            }},
+            {"has_won_dfs", [&] {
+                benchmarkSink += position.hasWonByDfs((next++ & 1) ? 1 : -1);
+            }},
+            {"random_move", [&] {
+                benchmarkSink += randomPlayer.getMove().first;
+            }},
+            {"is_full", [&] {
+                benchmarkSink += position.isFull();
+            }},
+            {"get_neighbours", [&] {
+                int cell = next++ % (size * size);
+                int player = position.getValue(cell / size, cell % size);
+                benchmarkSink += position.getNeighbours(player == 0 ? 1 : player, cell / size, cell % size).size();
+            }},
+            {"evaluate_position", [&] {
+                benchmarkSink += position.evaluatePosition((next++ & 1) ? 1 : -1);
+            }},
+            {"connection_distance", [&] {
+                benchmarkSink += position.connectionDistance((next++ & 1) ? 1 : -1);
+            }},
+            {"playout_empty", [&] {
+                benchmarkSink += engine.playout(emptyBoard, 1);
+            }},
+            {"playout_midgame", [&] {
+                benchmarkSink += engine.playout(position, 1);
+            }},
+        };
+        
+        for (auto& [name, op] : operations) {
+            double nanos = measureNanosPerCall(op, sampleMs, SAMPLES);
+            table.addRow({size, name, nanos, static_cast<long long>(1e9 / nanos)});
+        }
+    }
+    table.write(out, format);
+}
+
+// Measure alpha-beta search on seeded mid-game positions, with and without
+// move ordering: deepest completed iteration, speed and effective branching
+// factor for the same node budget
+void runAlphaBetaBenchmark(std::ostream& out, const std::string& format) {
+    const long long NODES = 500000;
+    if (format == "text") {
+        out << "Alpha-beta benchmark (" << NODES << " nodes per search, seeded mid-game positions)" << std::endl;
+    }
+    
+    ResultTable table({"size", "ordering", "depth", "nodes", "seconds", "nodes_per_sec", "branching_factor"});
+    for (int size : {7, 9, 11}) {
+        for (bool ordering : {true, false}) {
+            Board position = makeBenchmarkPosition(size, 12345u + size);
+            AlphaBetaPlayer player(position, 1);
+            player.setMoveOrdering(ordering);
+            SearchBudget budget;
+            budget.playouts = NODES;
+            player.setBudget(budget);
+            player.getMove();
             
-            // Reset game state
-            int gameCurrentPlayer = 1;
-            bool gameOver = false;
+            const SearchStats& stats = *player.getSearchStats();
+            table.addRow({size, ordering ? "on" : "off", stats.depth, stats.playouts, stats.seconds,
+                          static_cast<long long>(stats.playouts / stats.seconds), stats.branchingFactor});
+        }
+    }
+    table.write(out, format);
+}
+
+// Every kernel implementation for board size n: the DynamicShape one, and
+// for the compiled-in sizes the FixedShape one and, on a processor with
+// AVX2, the AVX2 one, whichever kernelsForSize installed
+template <int N>
+void addFixedKernels(std::vector<std::pair<std::string, BoardKernels>>& variants) {
+    variants.push_back({"fixed", BoardKernels::make<FixedShape<N>>()});
+#ifdef NASH_AVX2
+    if (cpuHasAvx2()) variants.push_back({"avx2", BoardKernels::makeAvx<N>()});
+#endif
+}
+
+std::vector<std::pair<std::string, BoardKernels>> kernelVariants(int n) {
+    std::vector<std::pair<std::string, BoardKernels>> variants = {{"dynamic", BoardKernels::make<DynamicShape>()}};
+    switch (n) {
+        case 7: addFixedKernels<7>(variants); break;
+        case 9: addFixedKernels<9>(variants); break;
+        case 11: addFixedKernels<11>(variants); break;
+        case 13: addFixedKernels<13>(variants); break;
+        case 19: addFixedKernels<19>(variants); break;
+        default: break;
+    }
+    return variants;
+}
+
+// Board check: random sequences of placements, undos of the last stone,
+// removals of other stones and copies, with every incremental result of
+// Board compared after each step against a naive recomputation from a plain
+// array of cells: the three win tests, connectionDistance and
+// hasCompleteLineWin under every kernel implementation, the scores, the
+// hash, isFull and the empty list (whose order an undo must restore).
+// Returns 1 on any mismatch.
+int runBoardCheck(std::ostream& out, const std::string& format, unsigned int seed, int stepsPerSize) {
+    if (format == "text") {
+        out << "Board check (" << stepsPerSize << " random steps per size, seed " << seed << ")" << std::endl;
+    }
+    
+    ResultTable table({"size", "steps", "decided", "checks", "kernels", "mismatches", "result"});
+    bool passed = true;
+    for (int size : {3, 5, 7, 9, 11, 13, 19, 23}) {
+        const int numCells = size * size;
+        const BoardGeometry& geometry = BoardGeometry::forSize(size);
+        const auto variants = kernelVariants(size);
+        FastRng rng(mixSeed(seed, size));
+        long long checks = 0;
+        long long mismatches = 0;
+        auto expect = [&](bool ok) {
+            checks++;
+            if (!ok) mismatches++;
+        };
+        
+        Board board(size);
+        std::vector<int> cells(numCells, 0);            // The reference position
+        std::vector<int> placed;                        // Cells in placement order
+        std::vector<std::vector<int16_t>> emptyBefore;  // Empty list before each placement
+        std::vector<int> queue;
+        std::vector<int> next;
+        std::vector<int> dist;
+        std::vector<int> sorted;
+        
+        auto emptyList = [&] {
+            return std::vector<int16_t>(board.getEmptyList(), board.getEmptyList() + board.getEmptyCount());
+        };
+        auto owner = [&](int x, int y) {
+            return (x < 0 || x >= size || y < 0 || y >= size) ? -999 : cells[x * size + y];
+        };
+        auto onStart = [&](int cell, int player) {
+            return player == 1 ? cell % size == 0 : cell / size == 0;
+        };
+        auto onGoal = [&](int cell, int player) {
+            return player == 1 ? cell % size == size - 1 : cell / size == size - 1;
+        };
+        // 0-1 breadth-first search from the start edge, one distance layer at
+        // a time: own stones cost 0, empty cells 1, opponent stones are walls.
+        // With 'stonesOnly' empty cells are walls too, so the result is 0 if
+        // and only if the player's stones connect the edges.
+        auto shortestPath = [&](int player, bool stonesOnly) {
+            const int WALL = -1;
+            auto cost = [&](int value) {
+                if (value == player) return 0;
+                return (value == 0 && !stonesOnly) ? 1 : WALL;
+            };
+            dist.assign(numCells, INT32_MAX);
+            queue.clear();
+            next.clear();
+            for (int cell = 0; cell < numCells; cell++) {
+                int c = cost(cells[cell]);
+                if (onStart(cell, player) && c != WALL) {
+                    dist[cell] = c;
+                    (c == 0 ? queue : next).push_back(cell);
+                }
+            }
+            for (int d = 0; !queue.empty() || !next.empty(); d++) {
+                for (size_t i = 0; i < queue.size(); i++) {
+                    int cell = queue[i];
+                    if (dist[cell] != d) continue;
+                    for (int k = 0; k < 6; k++) {
+                        int nx = cell / size + DX[k];
+                        int ny = cell % size + DY[k];
+                        int value = owner(nx, ny);
+                        if (value == -999 || cost(value) == WALL) continue;
+                        int neighbour = nx * size + ny;
+                        if (d + cost(value) < dist[neighbour]) {
+                            dist[neighbour] = d + cost(value);
+                            (cost(value) == 0 ? queue : next).push_back(neighbour);
+                        }
+                    }
+                }
+                queue.swap(next);
+                next.clear();
+            }
+            int best = numCells + 1;
+            for (int cell = 0; cell < numCells; cell++) {
+                if (onGoal(cell, player) && dist[cell] < best) best = dist[cell];
+            }
+            return best;
+        };
+        
+        auto check = [&] {
+            const uint64_t* white = board.getStones(1);
+            const uint64_t* black = board.getStones(-1);
+            uint64_t hash = 0;
+            int whiteScore = 0;
+            int blackScore = 0;
+            int empty = 0;
+            for (int cell = 0; cell < numCells; cell++) {
+                int value = cells[cell];
+                expect(board.getValue(cell / size, cell % size) == value);
+                if (value == 0) {
+                    empty++;
+                    continue;
+                }
+                hash ^= ZobristKeys::instance().key(cell, value);
+                whiteScore += value * (cell % size + 1);
+                blackScore -= value * (cell / size + 1);
+            }
+            expect(board.getHash() == hash);
+            expect(board.evaluatePosition(1) == whiteScore && board.evaluatePosition(-1) == blackScore);
+            expect(board.getStoneCount() == numCells - empty && board.isFull() == (empty == 0));
             
-            std::cout << "Game " << game + 1 << " of " << numGames << std::endl;
+            // The empty list holds each empty cell exactly once
+            expect(board.getEmptyCount() == empty);
+            std::vector<int16_t> list = emptyList();
+            sorted.assign(list.begin(), list.end());
+            std::sort(sorted.begin(), sorted.end());
+            std::vector<int> scan;
+            board.getEmptyCells(scan);
+            expect(sorted == scan);
+            for (int cell : scan) expect(cells[cell] == 0);
             
-            while (!gameOver) {
-                // Get the current player
-                Player* currentPlayerObj = (gameCurrentPlayer == 1) ? player1 : player2;
+            for (int player : {1, -1}) {
+                bool won = shortestPath(player, true) == 0;
+                expect(board.hasWon(player) == won);
+                expect(board.hasWonByDfs(player) == won);
+                expect(board.hasWonByFloodFill(player) == won);
+                int distance = shortestPath(player, false);
+                expect(board.connectionDistance(player) == distance);
+                bool line = false;
+                for (int i = 0; i < size && !line; i++) {
+                    bool full = true;
+                    for (int j = 0; j < size && full; j++) {
+                        full = (player == 1 ? owner(i, j) : owner(j, i)) == player;
+                    }
+                    line = full;
+                }
+                expect(board.hasCompleteLineWin(player) == line);
                 
-                // Get the move from the current player
-                std::pair<int, int> move = currentPlayerObj->getMove();
-                int x = move.first;
-                int y = move.second;
+                const uint64_t* stones = player == 1 ? white : black;
+                const uint64_t* from = player == 1 ? geometry.leftEdge : geometry.topEdge;
+                const uint64_t* to = player == 1 ? geometry.rightEdge : geometry.bottomEdge;
+                for (const auto& variant : variants) {
+                    expect(variant.second.connects(geometry, stones, from, to) == won);
+                    expect(variant.second.connectionDistance(geometry, white, black, player) == distance);
+                    expect(variant.second.hasLine(geometry, stones, player) == line);
+                }
+            }
+        };
+        
+        auto place = [&] {
+            int cell = board.getEmptyList()[randomBelow(rng, board.getEmptyCount())];
+            int player = randomBelow(rng, 2) ? 1 : -1;
+            emptyBefore.push_back(emptyList());
+            expect(board.makeMove(cell / size, cell % size, player));
+            cells[cell] = player;
+            placed.push_back(cell);
+        };
+        
+        long long decided = 0;      // Checked positions in which a player has won
+        for (int step = 0; step < stepsPerSize; step++) {
+            uint32_t action = randomBelow(rng, 100);
+            if (action < 60 && !board.isFull()) {
+                // Place a stone of either colour
+                place();
+            } else if (action < 85 && !placed.empty()) {
+                // Undo the last stone; the empty list must come back exactly
+                int cell = placed.back();
+                placed.pop_back();
+                expect(board.makeMove(cell / size, cell % size, 0));
+                cells[cell] = 0;
+                if (!emptyBefore.back().empty()) expect(emptyList() == emptyBefore.back());
+                emptyBefore.pop_back();
+            } else if (action < 93 && !placed.empty()) {
+                // Remove some other stone, out of order
+                size_t index = randomBelow(rng, static_cast<uint32_t>(placed.size()));
+                int cell = placed[index];
+                placed.erase(placed.begin() + index);
+                emptyBefore.erase(emptyBefore.begin() + index);
+                // The list is rebuilt, so no recorded order applies any more
+                for (std::vector<int16_t>& list : emptyBefore) list.clear();
+                expect(board.makeMove(cell / size, cell % size, 0));
+                cells[cell] = 0;
+            } else if (action < 97) {
+                // Continue on a copy
+                Board copy(board);
+                board = copy;
+            } else {
+                // Start over from a random number of stones, so full and
+                // decided boards come up on every size
+                board = Board(size);
+                std::fill(cells.begin(), cells.end(), 0);
+                placed.clear();
+                emptyBefore.clear();
+                int stones = static_cast<int>(randomBelow(rng, numCells + 1));
+                for (int i = 0; i < stones; i++) place();
+            }
+            check();
+            if (board.hasWon(1) || board.hasWon(-1)) decided++;
+        }
+        
+        std::string names;
+        for (const auto& variant : variants) {
+            names += (names.empty() ? "" : "+") + variant.first;
+        }
+        passed = passed && mismatches == 0;
+        table.addRow({size, stepsPerSize, decided, checks, names, mismatches, mismatches == 0 ? "pass" : "FAIL"});
+    }
+    table.write(out, format);
+    return passed ? 0 : 1;
+}
+
+// Allocation check: every computer player type plays one game against
+// itself. Its first WARMUP_MOVES searches may size the player's buffers;
+// after that, no move may allocate on any thread. Returns 1 if one did.
+int runAllocationCheck(std::ostream& out, const std::string& format, int size, const PlayerSettings& settings) {
+#ifdef NASH_NO_TELEMETRY
+    (void)out;
+    (void)format;
+    (void)size;
+    (void)settings;
+    std::cerr << "Error: the allocation check needs the telemetry counters (built with NASH_NO_TELEMETRY)"
+              << std::endl;
+    return 1;
+#else
+    const int WARMUP_MOVES = 2;     // Per player
+    if (format == "text") {
+        out << "Allocation check on " << size << "x" << size << " (heap allocations after "
+            << WARMUP_MOVES << " warm-up moves per player)" << std::endl;
+    }
+    
+    ResultTable table({"player", "moves", "checked", "allocations", "bytes", "result"});
+    bool passed = true;
+    for (int type = 1; type <= 5; type++) {
+        Board board(size);
+        PlayerSettings playerSettings = settings;
+        playerSettings.seed = mixSeed(settings.seed, 0);
+        std::unique_ptr<Player> white(createPlayer(type, board, 1, playerSettings));
+        playerSettings.seed = mixSeed(settings.seed, 1);
+        std::unique_ptr<Player> black(createPlayer(type, board, -1, playerSettings));
+        
+        int current = 1;
+        int moves = 0;
+        int checked = 0;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        while (true) {
+            Player& player = (current == 1) ? *white : *black;
+            TelemetrySnapshot before = Telemetry::snapshot(true);
+            std::pair<int, int> move = player.getMove();
+            TelemetrySnapshot work = Telemetry::snapshot(true) - before;
+            if (moves >= 2 * WARMUP_MOVES) {
+                checked++;
+                allocations += work.counts[COUNT_ALLOCATIONS];
+                bytes += work.counts[COUNT_ALLOCATED_BYTES];
+            }
+            moves++;
+            if (!board.makeMove(move.first, move.second, current) || board.hasWon(current)) break;
+            current = -current;
+        }
+        
+        bool ok = allocations == 0;
+        passed = passed && ok;
+        table.addRow({playerTypeName(type), moves, checked, static_cast<long long>(allocations),
+                      static_cast<long long>(bytes), ok ? "pass" : "FAIL"});
+    }
+    table.write(out, format);
+    return passed ? 0 : 1;
+#endif
+}
+
+// Book mode: search the opening positions of every size in 'sizes' with
+// player type 'searcher' and write the book to 'path'. For each colour the
+// book covers the first 'plies' plies along its own book moves against every
+// reply of the opponent, so either side can follow it from the first move.
+int runBookBuilder(std::ostream& out, const std::string& format, const std::string& path,
+                   const std::vector<int>& sizes, int plies, int searcher, int threads,
+                   const PlayerSettings& settings) {
+    auto replay = [](int size, const std::vector<int>& line) {
+        Board board(size);
+        for (size_t i = 0; i < line.size(); i++) {
+            board.makeMove(line[i] / size, line[i] % size, i % 2 == 0 ? 1 : -1);
+        }
+        return board;
+    };
+    
+    if (format == "text") {
+        out << "Building opening book '" << path << "' (" << plies << " plies, "
+            << playerTypeName(searcher) << " search)" << std::endl;
+    }
+    std::map<std::pair<int, uint64_t>, BookEntry> moves;
+    std::vector<std::pair<int, double>> built;      // (positions, seconds) per size
+    uint64_t searches = 0;
+    ThreadPool pool(threads);
+    for (int size : sizes) {
+        auto start = std::chrono::steady_clock::now();
+        size_t before = moves.size();
+        for (int user : {1, -1}) {
+            std::vector<std::vector<int>> lines = {{}};
+            for (int ply = 0; ply < plies && !lines.empty(); ply++) {
+                // One line per position, keyed by its stored orientation
+                std::map<uint64_t, std::vector<int>> positions;
+                for (const std::vector<int>& line : lines) {
+                    Board board = replay(size, line);
+                    if (!board.hasWon(1) && !board.hasWon(-1)) {
+                        positions.emplace(std::min(board.getHash(), rotatedHash(board)), line);
+                    }
+                }
                 
-                // Make the move
-                if (newBoard.makeMove(x, y, gameCurrentPlayer)) {
-                    // Check if the current player has won
-                    if (newBoard.hasWon(gameCurrentPlayer)) {
-                        if (gameCurrentPlayer == 1) {
-                            player1Wins++;
-                        } else {
-                            player2Wins++;
+                std::vector<std::vector<int>> next;
+                int mover = (ply % 2 == 0) ? 1 : -1;
+                if (mover != user) {
+                    std::vector<int> cells;
+                    for (const auto& position : positions) {
+                        replay(size, position.second).getEmptyCells(cells);
+                        for (int cell : cells) {
+                            next.push_back(position.second);
+                            next.back().push_back(cell);
                         }
-                        gameOver = true;
-                        continue;
-                    }
-                    
-                    // Check if the board is full
-                    if (newBoard.isFull()) {
-                        gameOver = true;
-                        continue;
                     }
-                    
-                    // Switch players
-                    gameCurrentPlayer = -gameCurrentPlayer;
+                    lines = std::move(next);
+                    continue;
+                }
+                
+                std::vector<const std::vector<int>*> todo;
+                for (const auto& position : positions) {
+                    if (moves.find({size, position.first}) == moves.end()) todo.push_back(&position.second);
+                }
+                std::vector<BookEntry> found(todo.size());
+                pool.run(static_cast<int>(todo.size()), [&](int task, int) {
+                    Board board = replay(size, *todo[task]);
+                    PlayerSettings searchSettings = settings;
+                    searchSettings.book = nullptr;
+                    searchSettings.seed = mixSeed(settings.seed, searches + task);
+                    std::unique_ptr<Player> player(createPlayer(searcher, board, mover, searchSettings));
+                    std::pair<int, int> move = player->getMove();
+                    int cell = move.first * size + move.second;
+                    uint64_t hash = board.getHash();
+                    uint64_t rotated = rotatedHash(board);
+                    const SearchStats* stats = player->getSearchStats();
+                    found[task].key = std::min(hash, rotated);
+                    found[task].size = static_cast<uint16_t>(size);
+                    found[task].move = static_cast<uint16_t>(hash <= rotated ? cell : size * size - 1 - cell);
+                    found[task].playouts = stats ? static_cast<uint32_t>(stats->playouts) : 0;
+                });
+                searches += todo.size();
+                for (const BookEntry& entry : found) {
+                    moves[{size, entry.key}] = entry;
+                }
+                
+                // Continue every line with its book move
+                for (const auto& position : positions) {
+                    Board board = replay(size, position.second);
+                    const BookEntry& entry = moves[{size, position.first}];
+                    int cell = board.getHash() <= rotatedHash(board) ? entry.move : size * size - 1 - entry.move;
+                    next.push_back(position.second);
+                    next.back().push_back(cell);
                 }
+                lines = std::move(next);
             }
-            
-            std::cout << "Game " << game + 1 << " complete." << std::endl;
         }
-        
-        std::cout << "Results after " << numGames << " games:" << std::endl;
-        std::cout << "Player 1 (White) wins: " << player1Wins << std::endl;
-        std::cout << "Player 2 (Black) wins: " << player2Wins << std::endl;
+        built.push_back({static_cast<int>(moves.size() - before),
+                         std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()});
+    }
+    
+    if (!writeOpeningBook(path, moves)) {
+        std::cerr << "Error: cannot write '" << path << "'" << std::endl;
+        return 1;
     }
+    OpeningBook book;
+    if (!book.open(path)) {
+        std::cerr << "Error: cannot map '" << path << "'" << std::endl;
+        return 1;
+    }
+    ResultTable table({"size", "positions", "seconds", "lookup_ns"});
+    for (size_t i = 0; i < sizes.size(); i++) {
+        const Board emptyBoard(sizes[i]);
+        double lookupNs = measureNanosPerCall([&] { benchmarkSink += book.lookup(emptyBoard); }, 20, 5);
+        table.addRow({sizes[i], built[i].first, built[i].second, lookupNs});
+    }
+    table.write(out, format);
+    return 0;
+}
+
+// Settings for a non-interactive run, read from command-line flags and/or a
+// config file of "key = value" lines using the same keys as the flags
+struct CommandLineOptions {
+    std::string mode = "play";      // play, match, replay, book, bench, bench-rave or bench-alphabeta
+    int size = 7;
+    int player1 = 4;                // Player type of player 1 / player A
+    int player2 = 1;                // Player type of player 2 / player B
+    int games = 100;
+    bool seedGiven = false;
+    unsigned int seed = 0;
+    int threads = 1;                // Games run in parallel in match mode
+    int playerThreads = 1;          // Worker threads inside Monte Carlo players
+    long long playouts = 0;         // Per-move playout budget (0: player default)
+    int timeMs = 0;                 // Per-move time budget (0: none)
+    bool swapSides = true;
+    std::string format = "text";    // text, json or csv
+    std::string output;             // Result file; empty for standard output
+    std::vector<int> benchSizes = {3, 5, 7, 9, 11, 13, 15, 17, 19};
+    int benchMs = 20;               // Length of one benchmark sample
+    SmartEvaluator smartEvaluator = SmartEvaluator::Positional;
+    std::string record;             // Append played games to this file; empty for none
+    std::string input;              // Game records read in replay mode
+    int game = -1;                  // Game shown in replay mode; -1 for a summary
+    std::string book;               // Opening book to play from, or to build in book mode
+    int bookPlies = 3;              // Plies covered by a new book
+    std::vector<int> bookSizes = {7};
+    std::string telemetry;          // Per-move telemetry log; empty for none
+    std::string trace;              // Chrome trace of the timed phases; empty for none
 };
 
-int main() {
+void printUsage(std::ostream& out) {
+    out << "Usage: Nashgame [options]" << std::endl
+        << "Without options the game starts interactively." << std::endl
+        << "  --mode MODE           play, match, replay, book, bench, bench-rave," << std::endl
+        << "                        bench-alphabeta, check-board or check-alloc (default play)" << std::endl
+        << "  --size N              board size, 3-" << MAX_BOARD_SIZE << " (default 7)" << std::endl
+        << "  --p1 TYPE, --p2 TYPE  player types: human, random, smart, montecarlo, mcts," << std::endl
+        << "                        alphabeta or 0-5 (default mcts vs random)" << std::endl
+        << "  --games N             games in match mode (default 100)" << std::endl
+        << "  --seed N              base seed (default: current time)" << std::endl
+        << "  --threads N           games played in parallel in match mode (default 1)" << std::endl
+        << "  --player-threads N    worker threads inside Monte Carlo players (default 1)" << std::endl
+        << "  --playouts N          playouts per move for search players" << std::endl
+        << "  --time-ms N           time per move in ms for search players" << std::endl
+        << "  --no-swap             player 1 always plays White in match mode" << std::endl
+        << "  --smart-eval EVAL     Smart player evaluation: positional or shortest-path" << std::endl
+        << "                        (default positional)" << std::endl
+        << "  --format FORMAT       text, json or csv (default text)" << std::endl
+        << "  --output FILE         write results to FILE instead of standard output" << std::endl
+        << "  --record FILE         append played games to FILE (binary; text if it ends in .sgf)" << std::endl
+        << "  --input FILE          game records to summarise in replay mode" << std::endl
+        << "  --game N              replay mode: show game N move by move" << std::endl
+        << "  --book FILE           play from opening book FILE; in book mode, build it" << std::endl
+        << "                        by searching with the --p1 player" << std::endl
+        << "  --book-plies N        plies a new book covers (default 3)" << std::endl
+        << "  --book-sizes LIST     board sizes of a new book (default 7)" << std::endl
+        << "  --telemetry FILE      play and match modes: log the work behind every move" << std::endl
+        << "                        to FILE as JSON lines" << std::endl
+        << "  --trace FILE          write the timed phases as a Chrome trace to FILE" << std::endl
+        << "  --bench-sizes LIST    board sizes for the benchmark suite (default 3,5,...,19)" << std::endl
+        << "  --bench-ms N          length of one benchmark sample in ms (default 20)" << std::endl
+        << "  --config FILE         read \"key = value\" lines (keys as above, swap = false)" << std::endl
+        << "  --bench, --bench-rave, --bench-alphabeta" << std::endl
+        << "                        shorthand for --mode bench / bench-rave / bench-alphabeta" << std::endl;
+}
+
+// Accept a player type by number or by name
+bool parsePlayerType(const std::string& text, int& type) {
+    const char* names[] = {"human", "random", "smart", "montecarlo", "mcts", "alphabeta"};
+    for (int i = 0; i < 6; i++) {
+        if (text == names[i] || text == std::to_string(i)) {
+            type = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseNumber(const std::string& text, long long minimum, long long maximum, long long& value) {
+    try {
+        size_t used = 0;
+        value = std::stoll(text, &used);
+        return used == text.size() && value >= minimum && value <= maximum;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool readConfigFile(const std::string& path, CommandLineOptions& options, std::string& error);
+
+// Parse a comma-separated list of board sizes into 'sizes'
+bool parseSizeList(const std::string& text, int minimum, std::vector<int>& sizes) {
+    std::vector<int> parsed;
+    std::stringstream list(text);
+    std::string item;
+    long long number = 0;
+    while (std::getline(list, item, ',')) {
+        if (!parseNumber(item, minimum, MAX_BOARD_SIZE, number)) return false;
+        parsed.push_back(static_cast<int>(number));
+    }
+    if (parsed.empty()) return false;
+    sizes = parsed;
+    return true;
+}
+
+// Apply one option; 'error' explains a rejected key or value
+bool setOption(const std::string& key, const std::string& value, CommandLineOptions& options,
+               std::string& error) {
+    long long number = 0;
+    bool ok = true;
+    if (key == "mode") {
+        ok = value == "play" || value == "match" || value == "replay" || value == "book"
+             || value == "bench" || value == "bench-rave" || value == "bench-alphabeta"
+             || value == "check-board" || value == "check-alloc";
+        if (ok) options.mode = value;
+    } else if (key == "size") {
+        ok = parseNumber(value, 3, MAX_BOARD_SIZE, number);
+        if (ok) options.size = static_cast<int>(number);
+    } else if (key == "p1") {
+        ok = parsePlayerType(value, options.player1);
+    } else if (key == "p2") {
+        ok = parsePlayerType(value, options.player2);
+    } else if (key == "games") {
+        ok = parseNumber(value, 1, 100000000, number);
+        if (ok) options.games = static_cast<int>(number);
+    } else if (key == "seed") {
+        ok = parseNumber(value, 0, 4294967295LL, number);
+        if (ok) {
+            options.seed = static_cast<unsigned int>(number);
+            options.seedGiven = true;
+        }
+    } else if (key == "threads") {
+        ok = parseNumber(value, 1, 1024, number);
+        if (ok) options.threads = static_cast<int>(number);
+    } else if (key == "player-threads") {
+        ok = parseNumber(value, 1, 1024, number);
+        if (ok) options.playerThreads = static_cast<int>(number);
+    } else if (key == "playouts") {
+        ok = parseNumber(value, 0, 1000000000000LL, number);
+        if (ok) options.playouts = number;
+    } else if (key == "time-ms") {
+        ok = parseNumber(value, 0, 86400000, number);
+        if (ok) options.timeMs = static_cast<int>(number);
+    } else if (key == "swap") {
+        ok = value == "true" || value == "false";
+        if (ok) options.swapSides = value == "true";
+    } else if (key == "smart-eval") {
+        ok = value == "positional" || value == "shortest-path";
+        if (ok) {
+            options.smartEvaluator = value == "positional" ? SmartEvaluator::Positional
+                                                           : SmartEvaluator::ShortestPath;
+        }
+    } else if (key == "format") {
+        ok = value == "text" || value == "json" || value == "csv";
+        if (ok) options.format = value;
+    } else if (key == "output") {
+        options.output = value;
+    } else if (key == "record") {
+        options.record = value;
+    } else if (key == "input") {
+        options.input = value;
+    } else if (key == "game") {
+        ok = parseNumber(value, 0, 100000000, number);
+        if (ok) options.game = static_cast<int>(number);
+    } else if (key == "book") {
+        options.book = value;
+    } else if (key == "book-plies") {
+        ok = parseNumber(value, 1, 8, number);
+        if (ok) options.bookPlies = static_cast<int>(number);
+    } else if (key == "book-sizes") {
+        ok = parseSizeList(value, 3, options.bookSizes);
+    } else if (key == "telemetry") {
+        options.telemetry = value;
+    } else if (key == "trace") {
+        options.trace = value;
+    } else if (key == "bench-sizes") {
+        ok = parseSizeList(value, 1, options.benchSizes);
+    } else if (key == "bench-ms") {
+        ok = parseNumber(value, 1, 60000, number);
+        if (ok) options.benchMs = static_cast<int>(number);
+    } else if (key == "config") {
+        return readConfigFile(value, options, error);
+    } else {
+        error = "unknown option '" + key + "'";
+        return false;
+    }
+    if (!ok) {
+        error = "invalid value '" + value + "' for " + key;
+    }
+    return ok;
+}
+
+bool readConfigFile(const std::string& path, CommandLineOptions& options, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open config file '" + path + "'";
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        size_t equals = line.find('=');
+        auto trim = [](const std::string& text) {
+            size_t first = text.find_first_not_of(" \t\r");
+            size_t last = text.find_last_not_of(" \t\r");
+            return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+        };
+        if (trim(line).empty()) continue;
+        if (equals == std::string::npos) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected key = value";
+            return false;
+        }
+        if (!setOption(trim(line.substr(0, equals)), trim(line.substr(equals + 1)), options, error)) {
+            error = path + ":" + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseCommandLine(int argc, char* argv[], CommandLineOptions& options, std::string& error) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bench" || arg == "--bench-rave" || arg == "--bench-alphabeta") {
+            options.mode = arg.substr(2);
+            continue;
+        }
+        if (arg == "--no-swap") {
+            options.swapSides = false;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0) {
+            error = "unexpected argument '" + arg + "'";
+            return false;
+        }
+        std::string key = arg.substr(2);
+        std::string value;
+        size_t equals = key.find('=');
+        if (equals != std::string::npos) {
+            value = key.substr(equals + 1);
+            key = key.substr(0, equals);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            error = "missing value for " + arg;
+            return false;
+        }
+        if (!setOption(key, value, options, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Run the mode selected on the command line without any prompts
+int runFromOptions(const CommandLineOptions& options) {
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Error: cannot write '" << options.output << "'" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    
+    if (options.mode == "bench") {
+        runBenchmarkSuite(out, options.format, options.benchSizes, options.benchMs);
+        return 0;
+    }
+    if (options.mode == "bench-rave") {
+        runRaveBenchmark(out, options.format);
+        return 0;
+    }
+    if (options.mode == "bench-alphabeta") {
+        runAlphaBetaBenchmark(out, options.format);
+        return 0;
+    }
+    if (options.mode == "replay") {
+        if (options.input.empty()) {
+            std::cerr << "Error: replay mode needs --input FILE" << std::endl;
+            return 1;
+        }
+        return runReplay(out, options.format, options.input, options.game);
+    }
+    
+    SearchBudget budget;
+    budget.playouts = options.playouts;
+    budget.timeMs = options.timeMs;
+    unsigned int seed = options.seedGiven ? options.seed : static_cast<unsigned int>(std::time(nullptr));
+    
+    if (options.mode == "check-board") {
+        const int STEPS = 10000;    // Random steps per board size
+        return runBoardCheck(out, options.format, seed, STEPS);
+    }
+    if (options.mode == "check-alloc") {
+        PlayerSettings settings;
+        settings.threads = options.playerThreads;
+        settings.budget = budget;
+        settings.seed = seed;
+        settings.smartEvaluator = options.smartEvaluator;
+        return runAllocationCheck(out, options.format, options.size, settings);
+    }
+    
+    if (options.mode == "book") {
+        if (options.book.empty() || options.player1 == 0) {
+            std::cerr << "Error: book mode needs --book FILE and a computer --p1 player" << std::endl;
+            return 1;
+        }
+        PlayerSettings settings;
+        settings.threads = options.playerThreads;
+        settings.budget = budget;
+        settings.seed = seed;
+        settings.smartEvaluator = options.smartEvaluator;
+        return runBookBuilder(out, options.format, options.book, options.bookSizes, options.bookPlies,
+                              options.player1, options.threads, settings);
+    }
+    
+    OpeningBook book;
+    if (!options.book.empty() && !book.open(options.book)) {
+        std::cerr << "Error: '" << options.book << "' is not an opening book" << std::endl;
+        return 1;
+    }
+    
+    std::unique_ptr<GameRecordWriter> recorder;
+    if (!options.record.empty()) {
+        recorder = std::make_unique<GameRecordWriter>(options.record);
+        if (!recorder->isOpen()) {
+            std::cerr << "Error: cannot write '" << options.record << "'" << std::endl;
+            return 1;
+        }
+    }
+    
+    std::unique_ptr<TelemetryLog> telemetry;
+    if (!options.telemetry.empty()) {
+        telemetry = std::make_unique<TelemetryLog>(options.telemetry);
+        if (!telemetry->isOpen()) {
+            std::cerr << "Error: cannot write '" << options.telemetry << "'" << std::endl;
+            return 1;
+        }
+        Telemetry::timing() = true;
+    }
+    
+    if (options.mode == "match") {
+        if (options.player1 == 0 || options.player2 == 0) {
+            std::cerr << "Error: match mode needs two computer players" << std::endl;
+            return 1;
+        }
+        MatchConfig config;
+        config.size = options.size;
+        config.typeA = options.player1;
+        config.typeB = options.player2;
+        config.games = options.games;
+        config.threads = options.threads;
+        config.swapSides = options.swapSides;
+        config.seed = seed;
+        config.players.threads = options.playerThreads;
+        config.players.budget = budget;
+        config.players.smartEvaluator = options.smartEvaluator;
+        config.recorder = recorder.get();
+        config.telemetry = telemetry.get();
+        if (telemetry) {
+            // Parallel games share the counters of all threads, so then count
+            // only the thread that plays each game
+            telemetry->setAllThreads(options.threads == 1);
+        }
+        config.players.book = book.isOpen() ? &book : nullptr;
+        
+        MatchResult result = MatchRunner(config).run();
+        if (options.format == "text") {
+            printMatchResult(out, config, result);
+        } else {
+            writeMatchResult(out, options.format, config, result);
+        }
+        return 0;
+    }
+    
+    // Single game, shown on standard output as in interactive mode
+    PlayerSettings settings;
+    settings.threads = options.playerThreads;
+    settings.budget = budget;
+    settings.seed = seed;
+    settings.smartEvaluator = options.smartEvaluator;
+    settings.book = book.isOpen() ? &book : nullptr;
+    NashGame game(options.size, options.player1, options.player2, settings);
+    game.setRecorder(recorder.get());
+    game.setTelemetry(telemetry.get());
+    game.play();
+    return 0;
+}
+
+// Ask for the game settings on standard input and play
+int runInteractive() {
     // Print welcome message
     std::cout << "Welcome to Nash (Hex) Game!" << std::endl;
     std::cout << "=============================" << std::endl;
@@ -704,23 +5317,39 @@ int main() {
     std::cout << "Enter board size (3-15 recommended): ";
     std::cin >> size;
     
-    while (size < 3) {
-        std::cout << "Board size must be at least 3. Try again: ";
+    while (size < 3 || size > MAX_BOARD_SIZE) {
+        std::cout << "Board size must be between 3 and " << MAX_BOARD_SIZE << ". Try again: ";
         std::cin >> size;
     }
     
     // Get player types
     int p1Type, p2Type;
     std::cout << "Select player 1 (White) type:" << std::endl;
-    std::cout << "0: Human, 1: Random, 2: Smart, 3: Monte Carlo: ";
+    std::cout << "0: Human, 1: Random, 2: Smart, 3: Monte Carlo, 4: MCTS, 5: Alpha-beta: ";
     std::cin >> p1Type;
     
     std::cout << "Select player 2 (Black) type:" << std::endl;
-    std::cout << "0: Human, 1: Random, 2: Smart, 3: Monte Carlo: ";
+    std::cout << "0: Human, 1: Random, 2: Smart, 3: Monte Carlo, 4: MCTS, 5: Alpha-beta: ";
     std::cin >> p2Type;
     
+    // Monte Carlo players can spread their simulations over several threads
+    int threads = 1;
+    if (p1Type == 3 || p2Type == 3) {
+        std::cout << "Worker threads for Monte Carlo (1 = single-threaded): ";
+        std::cin >> threads;
+        if (threads < 1) threads = 1;
+    }
+    
+    // Search players can be given a time limit instead of a fixed amount of work
+    SearchBudget budget;
+    if (p1Type >= 3 || p2Type >= 3) {
+        std::cout << "Time per move in ms for search players (0 = default playouts): ";
+        std::cin >> budget.timeMs;
+        if (budget.timeMs < 0) budget.timeMs = 0;
+    }
+    
     // Create and play the game
-    NashGame game(size, p1Type, p2Type);
+    NashGame game(size, p1Type, p2Type, threads, budget);
     
     // If both players are computer-controlled, ask if multiple games should be run
     if (p1Type > 0 && p2Type > 0) {
@@ -741,4 +5370,34 @@ int main() {
     game.play();
     
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 1) {
+        return runInteractive();
+    }
+    
+    CommandLineOptions options;
+    std::string error;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--help" || std::string(argv[i]) == "-h") {
+            printUsage(std::cout);
+            return 0;
+        }
+    }
+    if (!parseCommandLine(argc, argv, options, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        printUsage(std::cerr);
+        return 2;
+    }
+    if (!options.trace.empty()) {
+        Telemetry::timing() = true;
+        Telemetry::tracing() = true;
+    }
+    int status = runFromOptions(options);
+    if (!options.trace.empty() && !Telemetry::writeTrace(options.trace)) {
+        std::cerr << "Error: cannot write '" << options.trace << "'" << std::endl;
+        return 1;
+    }
+    return status;
+}